@@ -79,8 +79,9 @@ int main(void)
 void
 add_frames(uint8_t *f0, uint8_t *f1, int32_t rtc_fd)
 {
-    int32_t row, col, offset = 40, eof0 = 0, eof1 = 0, num_bytes;
-    int32_t fd0, fd1;
+    int32_t row, col, offset = 40, eof0 = 0, eof1 = 0;
+    int32_t fd0, fd1, size0, size1, pos0 = 0, pos1 = 0;
+    uint8_t *map0, *map1;
     struct mp1_blink_struct blink_struct;
     uint8_t c0 = '0', c1 = '0';
 
@@ -89,30 +90,37 @@ add_frames(uint8_t *f0, uint8_t *f1, int32_t rtc_fd)
 
     row = 0;
 
-    if( (fd0 = ece391_open(f0)) < 0 ) {
+    /* Map both frames once rather than reading them a byte per call */
+    if( (fd0 = ece391_open(f0)) < 0 || (size0 = ece391_mmap(fd0, (void**)&map0)) < 0 ) {
         ece391_halt(-1);
     }
-    if( (fd1 = ece391_open(f1)) < 0 ) {
+    if( (fd1 = ece391_open(f1)) < 0 || (size1 = ece391_mmap(fd1, (void**)&map1)) < 0 ) {
         ece391_halt(-1);
     }
 
+    /* The mappings outlive the descriptors */
+    ece391_close(fd0);
+    ece391_close(fd1);
+
     while(eof0 == 0 || eof1 == 0) {
         col = 0;
         while(1) {
 
             if(c0 != '\n') {
-                num_bytes = ece391_read(fd0, &c0, 1);
-                if(num_bytes == 0) {
+                if(pos0 == size0) {
                     c0 = '\n';
                     eof0 = 1;
+                } else {
+                    c0 = map0[pos0++];
                 }
             }
 
             if(c1 != '\n') {
-                num_bytes = ece391_read(fd1, &c1, 1);
-                if(num_bytes == 0) {
+                if(pos1 == size1) {
                     c1 = '\n';
                     eof1 = 1;
+                } else {
+                    c1 = map1[pos1++];
                 }
             }
 
@@ -130,22 +138,19 @@ add_frames(uint8_t *f0, uint8_t *f1, int32_t rtc_fd)
             col++;
         }
 
-        if(eof0) {
-            c0 = '\n';
-            ece391_close(fd0);
-        } else {
-            c0 = '0';
-        }
-
-        if(eof1) {
-            c1 = '\n';
-            ece391_close(fd1);
-        } else {
-            c1 = '0';
-        }
+        c0 = (eof0 ? '\n' : '0');
+        c1 = (eof1 ? '\n' : '0');
 
         row++;
     }
+
+    /* An empty file was never mapped */
+    if(size0 > 0) {
+        ece391_munmap(map0);
+    }
+    if(size1 > 0) {
+        ece391_munmap(map1);
+    }
 }
 
 uint8_t*
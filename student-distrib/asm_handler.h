@@ -11,6 +11,8 @@
 
 #include "types.h"
 
+#define PF_ERR_OFFSET 36		/* Bytes from esp to the page fault error code after the nine register pushes */
+
 #ifndef ASM
 
 /* Function declarations */
@@ -18,6 +20,8 @@ extern void asm_rtc_handler(void);
 extern void asm_keyboard_handler(void);
 extern void asm_int_ignore(void);
 extern void asm_timer_handler(void);
+extern void asm_yield_handler(void);
+extern void asm_page_fault_handler(void);
 
 #endif
 
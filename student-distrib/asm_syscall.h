@@ -11,12 +11,16 @@
 
 #include "types.h"
 
-#define NUM_SYSCALLS 9
+#define NUM_SYSCALLS 27
+#define EFLAGS_IF 0x200		/* Interrupt enable flag, sysenter clears it */
+#define USER_PAGE_START 0x08000000	/* V_PAGE, the caller's stack has to be in this 4MB page */
+#define USER_PAGE_END (USER_PAGE_START + 0x400000)	/* V_PAGE + FOUR_MB */
 
 #ifndef ASM
 
 /* Function declarations */
 extern void syscall_handler(void);
+extern void sysenter_handler(void);
 
 #endif
 
@@ -275,25 +275,36 @@ void general_protection(void)
 
 /* 
  * page_fault
- *   DESCRIPTION: handle Page fault exception #14
- *   INPUTS: none
+ *   DESCRIPTION: handle Page fault exception #14, the first touch of a user
+ *				  page gets its frame filled in and a write to a copy-on-write
+ *				  page gets its own copy, then the access is retried. Anything
+ *				  else kills the process
+ *   INPUTS: err_code - the error code pushed by the processor
  *   OUTPUTS: none
  *   RETURN VALUE: none
- *   SIDE EFFECTS: none
+ *   SIDE EFFECTS: may map a user page for the current process
  */
-void page_fault(void)
+void page_fault(uint32_t err_code)
 {
-	/* Mask interrupts and clear the screen */
-	int err_code;
+	uint32_t addr;
+	pcb_t * pcb = get_pcb();
 
-	cli();
-	clear();
-	/* Print the error message */
 	asm volatile(
 		 "movl %%cr2, %%ebx"
-		:"=b"(err_code)
+		:"=b"(addr)
 	);
-	printf("Page fault exception by address: %x\n", err_code);
+
+	/* A user page that has not been touched yet, or a write to a page shared after fork */
+	if(addr >= V_PAGE && addr < V_PAGE + FOUR_MB && pcb->task_id != 0){
+		if(!(err_code & PF_PRESENT) && 0 == fill_page(pcb, (void *)addr)) return;
+		if((err_code & PF_PRESENT) && (err_code & PF_WRITE) && 0 == cow_page(pcb->task_id, (void *)addr)) return;
+	}
+
+	/* Mask interrupts and clear the screen */
+	cli();
+	clear();
+	/* Print the error message */
+	printf("Page fault exception by address: %x\n", addr);
 	sys_halt(0);
 	while(1);
 }
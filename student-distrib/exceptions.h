@@ -46,7 +46,7 @@ extern void invalid_TSS(void);
 extern void segment_not_present(void);
 extern void stack_segment(void);
 extern void general_protection(void);
-extern void page_fault(void);
+extern void page_fault(uint32_t err_code);
 extern void coprocessor_error(void);
 extern void alignment_check(void);
 extern void machine_check(void);
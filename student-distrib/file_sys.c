@@ -6,22 +6,48 @@
 */
 
 #include "file_sys.h"
+#include "page_cache.h"
 
 /* File scope variables */
 static uint32_t file_addr;
 static uint32_t num_inodes;
+static uint32_t num_dentries;
+static uint32_t num_blocks;
+
+/* Counts changes to the length of any file, a length cached in a file_t
+   with an older count has to be read from the inode again */
+static uint32_t size_gen;
+
+/* One bit per data block and per inode, set when a file is using it */
+static uint32_t * block_map;
+static uint32_t * inode_map;
+
+/* Open addressed hash index from file name to dentry in the boot block,
+   dentry_slots is a power of two at least twice the number of dentries */
+static dentry_t ** dentry_index;
+static uint32_t dentry_slots;
+
+static uint32_t name_hash(const uint8_t* fname);
+static void build_dentry_index(void);
+static void index_dentry(dentry_t * d);
+static void build_alloc_maps(void);
+static int32_t alloc_bit(uint32_t * map, uint32_t count);
+static uint32_t grow_file(uint32_t inode, uint32_t length);
+static void zero_tail(uint32_t inode, uint32_t size);
+static void file_readahead(file_t * file, uint32_t nbytes);
 
 /* File operations tables */
 fops_t file_file_operations = {
 	.read = file_read,
 	.write = file_write,
 	.open = file_open,
-	.close = file_close
+	.close = file_close,
+	.readv = file_readv
 };
 
 fops_t dir_file_operations = {
 	.read = read_directory,
-	.write = file_write,
+	.write = dir_write,
 	.open = dir_open,
 	.close = file_close
 };
@@ -36,22 +62,143 @@ fops_t dir_file_operations = {
  */
 void init_file_sys(module_t * mod)
 {
-	/* Loop counter through 124 pages of filesys_img */
-	int i;
-
-	/* Map the module pointer */
-	for(i = 0; i < MAX_PROCESSES; i++){
-		map_page(i,(void *)mod,(void *)mod,DEFAULT_PDE);
-	}
+	/* Map the module pointer, process page directories copy it from the kernel's */
+	map_page(0,(void *)mod,(void *)mod,DEFAULT_PDE);
 
 	/* Set the file_addr to the base of filesys_img */
 	file_addr = mod->mod_start;
+	num_dentries = *((uint32_t *)file_addr);
 	num_inodes = *(((uint32_t *)file_addr) + 1);
+	num_blocks = *(((uint32_t *)file_addr) + 2);
+
+	build_dentry_index();
+	build_alloc_maps();
+}
+
+/* 
+ * build_dentry_index(void)
+ *   DESCRIPTION: Hashes every name in the boot block into dentry_index,
+ *				  sized from the dentry count so a bigger directory still
+ *				  gets a half empty table
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Takes frames for the index, leaves it NULL if there are none
+ */
+static void build_dentry_index(void)
+{
+	uint32_t i, frames;
+
+	/* Twice the dentries, rounded up to a power of two */
+	for(dentry_slots = 1; dentry_slots < 2 * num_dentries; dentry_slots <<= 1);
+	frames = (dentry_slots * PTR_SIZE + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	dentry_index = (dentry_t **)alloc_frames(frames, 1);
+	if(dentry_index == NULL) return;
+	memset(dentry_index, 0, frames * BLOCK_SIZE);
+
+	for(i = 0; i < num_dentries; i++){
+		index_dentry((dentry_t *)(file_addr + (i + 1) * NUM_DIR_ENTRIES));
+	}
+}
+
+/* 
+ * index_dentry(dentry_t * d)
+ *   DESCRIPTION: Hashes one dentry of the boot block into dentry_index
+ *   INPUTS: d - the dentry in the boot block
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: none
+ */
+static void index_dentry(dentry_t * d)
+{
+	uint32_t slot = name_hash((uint8_t *)d->file_name) & (dentry_slots - 1);
+
+	while(dentry_index[slot] != NULL) slot = (slot + 1) & (dentry_slots - 1);
+	dentry_index[slot] = d;
+}
+
+/* 
+ * build_alloc_maps(void)
+ *   DESCRIPTION: Marks the inode of every regular file and the data blocks
+ *				  inside its length as used, everything else is free for
+ *				  files that are created or grown
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Takes two frames for the maps, leaves them NULL if there
+ *				   are none, and then nothing can be written
+ */
+static void build_alloc_maps(void)
+{
+	uint32_t i, j, blocks;
+	uint32_t * curr_inode;
+	dentry_t * d;
+
+	if(num_blocks > MAP_BITS || num_inodes > MAP_BITS) return;
+	block_map = (uint32_t *)alloc_frames(2, 1);
+	if(block_map == NULL) return;
+	memset(block_map, 0, 2 * BLOCK_SIZE);
+	inode_map = block_map + BLOCK_SIZE / PTR_SIZE;
+
+	for(i = 0; i < num_dentries; i++){
+		d = (dentry_t *)(file_addr + (i + 1) * NUM_DIR_ENTRIES);
+		if(d->file_type != STDOUT || d->inode_num >= num_inodes) continue;
+		inode_map[d->inode_num / BITS_PER_LONG] |= 0x1 << (d->inode_num % BITS_PER_LONG);
+
+		curr_inode = (uint32_t *) (file_addr + (d->inode_num + 1) * BLOCK_SIZE);
+		blocks = (*curr_inode + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		for(j = 0; j < blocks && j < MAX_FILE_BLOCKS; j++){
+			if(curr_inode[j + 1] >= num_blocks) continue;
+			block_map[curr_inode[j + 1] / BITS_PER_LONG] |= 0x1 << (curr_inode[j + 1] % BITS_PER_LONG);
+		}
+	}
+}
+
+/* 
+ * alloc_bit(uint32_t * map, uint32_t count)
+ *   DESCRIPTION: Takes the lowest clear bit of an allocation map
+ *   INPUTS: map - block_map or inode_map
+ *			 count - the number of bits in use in the map
+ *   OUTPUTS: none
+ *   RETURN VALUE: the bit number, -1 if every bit is set
+ *   SIDE EFFECTS: sets the bit
+ */
+static int32_t alloc_bit(uint32_t * map, uint32_t count)
+{
+	uint32_t i;
+
+	for(i = 0; i < count; i++){
+		if(!(map[i / BITS_PER_LONG] & (0x1 << (i % BITS_PER_LONG)))){
+			map[i / BITS_PER_LONG] |= 0x1 << (i % BITS_PER_LONG);
+			return i;
+		}
+	}
+	return -1;
+}
+
+/* 
+ * name_hash(const uint8_t* fname)
+ *   DESCRIPTION: FNV-1a hash of a file name, only the first MAX_NAME_SIZE
+ *				  characters count just like in the boot block
+ *   INPUTS: fname - the file name
+ *   OUTPUTS: none
+ *   RETURN VALUE: the hash
+ *   SIDE EFFECTS: none
+ */
+static uint32_t name_hash(const uint8_t* fname)
+{
+	uint32_t i, hash = FNV_OFFSET;
+
+	for(i = 0; i < MAX_NAME_SIZE && fname[i] != '\0'; i++){
+		hash = (hash ^ fname[i]) * FNV_PRIME;
+	}
+	return hash;
 }
 
 /* 
  * read_dentry_by_name(const uint8 t* fname, dentry_t* dentry)
- *   DESCRIPTION: Crawls through file system and finds file with name "fname"
+ *   DESCRIPTION: Finds the file with name "fname" through the hash index, or
+ *				  by crawling the boot block if there is no index
  *   INPUTS: uint8_t * fname - name of file to find
  *			 dentry_t * dentry - pointer to struct which we copy data to
  *   OUTPUTS: none
@@ -60,7 +207,18 @@ void init_file_sys(module_t * mod)
  */
 int32_t read_dentry_by_name (const uint8_t* fname, dentry_t* dentry)
 {
-	uint32_t curr;
+	uint32_t curr, slot;
+
+	/* Probe from the name's slot until it turns up or an empty slot ends the run */
+	if(dentry_index != NULL){
+		for(slot = name_hash(fname) & (dentry_slots - 1); dentry_index[slot] != NULL; slot = (slot + 1) & (dentry_slots - 1)){
+			if(!strncmp(dentry_index[slot]->file_name, (int8_t *) fname, MAX_NAME_SIZE)){
+				*dentry = *dentry_index[slot];
+				return 0;
+			}
+		}
+		return -1;
+	}
 
 	/* search through directory entries by name and populate dentry when found */
 	for(curr = file_addr + NUM_DIR_ENTRIES; curr < file_addr + BLOCK_SIZE; curr += NUM_DIR_ENTRIES){
@@ -75,8 +233,8 @@ int32_t read_dentry_by_name (const uint8_t* fname, dentry_t* dentry)
 
 /* 
  * read_dentry_by_index (uint32_t index, dentry_t* dentry)
- *   DESCRIPTION: uint32_t index - crawls through file system and find file 
- *								   with input index
+ *   DESCRIPTION: uint32_t index - finds the file with input index, dentries
+ *								   sit one after another in the boot block
  *   INPUTS: uint8_t * index - index of file to find
  *			 dentry_t * dentry - pointer to struct which we copy data to
  *   OUTPUTS: none
@@ -85,16 +243,10 @@ int32_t read_dentry_by_name (const uint8_t* fname, dentry_t* dentry)
  */
 int32_t read_dentry_by_index (uint32_t index, dentry_t* dentry)
 {
-	uint32_t i, curr = file_addr + NUM_DIR_ENTRIES;
-	if(index >= NUM_DIR_ENTRIES) return -1;
-
-	/* search through directory entries */
-	for(i = 0; i < index; i++){
-		curr += NUM_DIR_ENTRIES;
-	}
+	if(index >= MAX_DENTRIES) return -1;
 
 	/* populate dentry */
-	*dentry = *((dentry_t *) curr);
+	*dentry = *((dentry_t *) (file_addr + (index + 1) * NUM_DIR_ENTRIES));
 	return 0;
 }
 
@@ -111,6 +263,40 @@ int32_t read_size (uint32_t inode)
 	return *((uint32_t *) (file_addr + (inode + 1) * BLOCK_SIZE));
 }
 
+/* 
+ * file_size(file_t * file)
+ *   DESCRIPTION: Gets the length of an open regular file from the copy in
+ *				  its file_t, the inode is only read again after some
+ *				  file's length has changed
+ *   INPUTS: file - the open regular file
+ *   OUTPUTS: none
+ *   RETURN VALUE: the length in bytes
+ *   SIDE EFFECTS: may refresh file_size and size_gen in the file_t
+ */
+uint32_t file_size(file_t * file)
+{
+	if(file->size_gen != size_gen){
+		file->file_size = read_size(file->inode_num);
+		file->size_gen = size_gen;
+	}
+	return file->file_size;
+}
+
+/* 
+ * cache_file_size(file_t * file)
+ *   DESCRIPTION: Reads the length of a regular file into its file_t as it
+ *				  is opened
+ *   INPUTS: file - the file being opened, inode_num already set
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: sets file_size and size_gen in the file_t
+ */
+void cache_file_size(file_t * file)
+{
+	file->file_size = read_size(file->inode_num);
+	file->size_gen = size_gen;
+}
+
 /* 
  * read_data(uint32_t inode, uint32_t offset, uint8_t* buf, uint32_t length)
  *   DESCRIPTION: checks if the given inode is within valid range, and if so,
@@ -128,53 +314,139 @@ int32_t read_data (uint32_t inode, uint32_t offset, uint8_t* buf, uint32_t lengt
 {
    /*
 	* curr_inode -- pointer to the beginning of the correct inode block
-	* i -- utility for looping
 	* count -- the number of bytes copied to buf so far
 	* size -- the number of bytes in the file
-	* block_ptr -- pointer to the part of the inode block that contains the data block index
-	* curr_block -- the index of the data block currently being copied from
-	* curr_byte -- the byte that needs to be copied from
+	* index -- which 4 KB page of the file is being copied from
+	* block_off -- where in the current page the copy starts
+	* span -- the number of bytes copied out of the current page
 	*/
-	uint32_t * curr_inode = (uint32_t *) (file_addr + (inode + 1) * BLOCK_SIZE);
-	uint32_t i, count = 0, size = *curr_inode;
-	uint32_t * block_ptr = (uint32_t *) (curr_inode + 1 + offset / BLOCK_SIZE);
-	uint32_t curr_block = *block_ptr;
-	uint8_t * curr_byte = (uint8_t *)(file_addr + (curr_block + num_inodes + 1) * BLOCK_SIZE + offset % BLOCK_SIZE);
+	uint32_t * curr_inode;
+	uint32_t count = 0, size, index, block_off, span, frame;
 
 	/* Check for failure on invalid inode index or offset greater than file size */
-	if(inode >= num_inodes || offset > size) return -1;
-	if(offset == size) return 0;
+	if(inode >= num_inodes) return -1;
+	curr_inode = (uint32_t *) (file_addr + (inode + 1) * BLOCK_SIZE);
+	size = *curr_inode;
+	if(offset > size) return -1;
+
+	/* Never copy past the end of the file */
+	if(length > size - offset) length = size - offset;
+
+	/* Copy the part of each page that is wanted in one memcpy, only the
+	   first page starts partway in. Pages come from the page cache, which
+	   reads them in from the image the first time. */
+	index = offset / BLOCK_SIZE;
+	block_off = offset % BLOCK_SIZE;
+	while(count < length){
+		span = BLOCK_SIZE - block_off;
+		if(span > length - count) span = length - count;
 
-	/* Start at the location indicated by the offset and copy until the end of the 
-	   data block, the end of the file, or the proper amount has been copied */
-	for(i = offset % BLOCK_SIZE; i < BLOCK_SIZE; i++){
-		buf[count] = *curr_byte;
-		count++;
-		if(count == length || count + offset >= size){
-			return count;
+		frame = page_cache_get(inode, index);
+		if(frame != 0){
+			memcpy(buf + count, (uint8_t *)(frame + block_off), span);
+			page_cache_put(frame);
 		}
-		curr_byte++;
+		else{
+			/* No room in the cache, a page it does not hold is current in the image */
+			memcpy(buf + count, (uint8_t *)(file_addr + (curr_inode[index + 1] + num_inodes + 1) * BLOCK_SIZE + block_off), span);
+		}
+
+		count += span;
+		block_off = 0;
+		index++;
 	}
 
-	/* Keep going through data blocks until the end of the file or the proper amount
-	   has been copied */
-	while(count < length){
-		block_ptr++;
-		curr_block = *block_ptr;
-		curr_byte = (uint8_t *)(file_addr + (curr_block + num_inodes + 1) * BLOCK_SIZE);
-		for(i = 0; i < BLOCK_SIZE; i++){
-			buf[count] = *curr_byte;
-			count++;
-			if(count == length || count + offset >= size){
-				return count;
+	return count;
+}
+
+/* 
+ * file_block(uint32_t inode, uint32_t index)
+ *   DESCRIPTION: Finds where one data block of a file sits in the image
+ *   INPUTS: inode - the inode of the file
+ *			 index - which 4 KB block of the file
+ *   OUTPUTS: none
+ *   RETURN VALUE: address of the data block, 0 if the file has no such block
+ *   SIDE EFFECTS: none
+ */
+uint32_t file_block(uint32_t inode, uint32_t index)
+{
+	uint32_t * curr_inode;
+
+	if(inode >= num_inodes) return 0;
+	curr_inode = (uint32_t *) (file_addr + (inode + 1) * BLOCK_SIZE);
+	if(index >= (*curr_inode + BLOCK_SIZE - 1) / BLOCK_SIZE) return 0;
+
+	return file_addr + (*(curr_inode + 1 + index) + num_inodes + 1) * BLOCK_SIZE;
+}
+
+#ifdef FS_SELF_TEST
+/* 
+ * read_byte(uint32_t inode, uint32_t pos)
+ *   DESCRIPTION: Reads one byte of a file straight from its data block, the
+ *				  reference read_data is checked against
+ *   INPUTS: inode - the inode of the file
+ *			 pos - the byte to read, must be inside the file
+ *   OUTPUTS: none
+ *   RETURN VALUE: the byte
+ *   SIDE EFFECTS: none
+ */
+static uint8_t read_byte(uint32_t inode, uint32_t pos)
+{
+	uint32_t * curr_inode = (uint32_t *) (file_addr + (inode + 1) * BLOCK_SIZE);
+	uint32_t block = *(curr_inode + 1 + pos / BLOCK_SIZE);
+	return *(uint8_t *)(file_addr + (block + num_inodes + 1) * BLOCK_SIZE + pos % BLOCK_SIZE);
+}
+
+/* 
+ * read_data_test(void)
+ *   DESCRIPTION: Reads every regular file at offsets and lengths on both sides
+ *				  of block boundaries, odd ones included, and compares each
+ *				  result byte for byte with read_byte. "make selftest" builds
+ *				  the kernel with -DFS_SELF_TEST so entry() runs it at boot.
+ *   INPUTS: none
+ *   OUTPUTS: prints a line per failure and a summary
+ *   RETURN VALUE: the number of failed reads
+ *   SIDE EFFECTS: none
+ */
+int32_t read_data_test(void)
+{
+	static uint8_t buf[TEST_BUF_SIZE];
+	static const uint32_t offsets[NUM_TEST_CASES] = {0, 1, 3, BLOCK_SIZE - 1, BLOCK_SIZE, BLOCK_SIZE + 1, 2 * BLOCK_SIZE - 3, 2 * BLOCK_SIZE + 5};
+	static const uint32_t lengths[NUM_TEST_CASES] = {0, 1, 7, BLOCK_SIZE - 1, BLOCK_SIZE, BLOCK_SIZE + 1, 2 * BLOCK_SIZE + 3, TEST_BUF_SIZE};
+	uint32_t d, i, j, k, size, offset, expect, tests = 0, failures = 0;
+	int32_t ret;
+	dentry_t dentry;
+
+	for(d = 0; d < num_dentries; d++){
+		if(-1 == read_dentry_by_index(d, &dentry) || dentry.file_type != STDOUT) continue;
+		size = read_size(dentry.inode_num);
+
+		/* One extra pass for the offset one byte before the end of the file */
+		for(i = 0; i <= NUM_TEST_CASES; i++){
+			offset = (i < NUM_TEST_CASES) ? offsets[i] : size - 1;
+			if(offset > size) continue;
+
+			for(j = 0; j < NUM_TEST_CASES; j++){
+				expect = size - offset;
+				if(expect > lengths[j]) expect = lengths[j];
+				tests++;
+
+				ret = read_data(dentry.inode_num, offset, buf, lengths[j]);
+				for(k = 0; ret == expect && k < expect; k++){
+					if(buf[k] != read_byte(dentry.inode_num, offset + k)) break;
+				}
+				if(ret != expect || k != expect){
+					printf("read_data mismatch: %s offset %d length %d\n", dentry.file_name, offset, lengths[j]);
+					failures++;
+				}
 			}
-			curr_byte++;
 		}
 	}
 
-	/* Should never reach here*/
-	return count;
+	printf("read_data self-test: %d of %d reads failed\n", failures, tests);
+	return failures;
 }
+#endif /* FS_SELF_TEST */
 
 /* 
  * read_directory()
@@ -183,7 +455,7 @@ int32_t read_data (uint32_t inode, uint32_t offset, uint8_t* buf, uint32_t lengt
  *			 const void* buf - pointer to data to write
  *			 int32_t nbytes - the amount to write
  *   OUTPUTS: none
- *   RETURN VALUE: nbytes - the number of bytes copied
+ *   RETURN VALUE: nbytes - the number of bytes copied, 0 after the last name
  *   SIDE EFFECTS: increment dir_index of current PCB file
  */
 int32_t read_directory(int32_t fd, void* buf, int32_t nbytes)
@@ -191,35 +463,62 @@ int32_t read_directory(int32_t fd, void* buf, int32_t nbytes)
 	/* Get the PCB and a pointer to the file_pos */
 	pcb_t * pcb = get_pcb();
 	uint32_t * dir_index = &(pcb->file_array[fd].file_pos);
-	if(nbytes > MAX_NAME_SIZE) nbytes = MAX_NAME_SIZE;
+	int32_t len;
+	dentry_t d;
 
 	/* Safety check */
 	if(buf == NULL) return -1;
 
-	/* Check for end of dir entries */
-	if(*dir_index > NUM_DIR_ENTRIES-1) return 0;
-
-	dentry_t d;
+	/* Check for end of dir entries, they are packed at the start of the boot block */
+	if(*dir_index >= num_dentries) return 0;
 	read_dentry_by_index(*dir_index,&d);
-	if(strlen(d.file_name) < MAX_NAME_SIZE){
-		nbytes = strlen(d.file_name);
-	}
-
-	/* Find the next non-empty directory entry */
-	while(d.file_name[0] == '\0' && (*dir_index < NUM_DIR_ENTRIES)){
-		(*dir_index)++;
-		read_dentry_by_index(*dir_index,&d);
-	}
 
-	/* Copy nbytes of file name into buffer */
+	/* Copy the name, which fills its field when it is MAX_NAME_SIZE long */
+	for(len = 0; len < MAX_NAME_SIZE && d.file_name[len] != '\0'; len++);
+	if(nbytes > len) nbytes = len;
 	memcpy((char*)buf, d.file_name, nbytes);
 
 	/* Move to next directory entry and return success */
 	(*dir_index)++;
-	if(*dir_index > NUM_DIR_ENTRIES-1) return 0;
 	return nbytes;
 }
 
+/* 
+ * read_dirents(int32_t fd, dirent_t* buf, int32_t nbytes)
+ *   DESCRIPTION: Fills buf with as many whole directory entries as fit,
+ *				  picking up after the last entry read from the directory
+ *   INPUTS: fd - an open directory
+ *			 buf - gets the entries
+ *			 nbytes - the size of buf
+ *   OUTPUTS: none
+ *   RETURN VALUE: the number of bytes filled, 0 after the last entry, -1 if
+ *				   buf cannot hold one entry
+ *   SIDE EFFECTS: increment dir_index of current PCB file
+ */
+int32_t read_dirents(int32_t fd, dirent_t* buf, int32_t nbytes)
+{
+	pcb_t * pcb = get_pcb();
+	uint32_t * dir_index = &(pcb->file_array[fd].file_pos);
+	uint32_t count = 0;
+	dentry_t * d;
+
+	if(buf == NULL || nbytes < 0) return -1;
+	if(*dir_index >= num_dentries) return 0;
+	if(nbytes < sizeof(dirent_t)) return -1;
+
+	/* Read straight out of the boot block, no copy of the dentry needed */
+	while(*dir_index < num_dentries && (count + 1) * sizeof(dirent_t) <= nbytes){
+		d = (dentry_t *)(file_addr + (*dir_index + 1) * NUM_DIR_ENTRIES);
+		memcpy(buf[count].file_name, d->file_name, MAX_NAME_SIZE);
+		buf[count].file_type = d->file_type;
+		buf[count].inode_num = d->inode_num;
+		buf[count].file_size = (d->file_type == STDOUT) ? read_size(d->inode_num) : 0;
+		count++;
+		(*dir_index)++;
+	}
+
+	return count * sizeof(dirent_t);
+}
 
 /* 
  * file_read(int32_t fd, void* buf, int32_t nbytes)
@@ -229,29 +528,164 @@ int32_t read_directory(int32_t fd, void* buf, int32_t nbytes)
  *			 int32_t nbytes - the amount to write
  *   OUTPUTS: none
  *   RETURN VALUE: -1 if error and bytes copied on success
- *   SIDE EFFECTS: increment file_pos in the file given by the fd
+ *   SIDE EFFECTS: increment file_pos in the file given by the fd, may read
+ *				   pages after it into the page cache
  */
 int32_t file_read(int32_t fd, void* buf, int32_t nbytes)
 {
 	/* Get the current PCB */
 	pcb_t * pcb = get_pcb();
+	file_t * file;
 	int32_t count;
 
-	/* Check for a valid fd */
-	if(fd < MIN_FD || fd > MAX_FD) return -1;
+	/* Check for a valid fd, reads at the end of the file stop here. The
+	   position can be past the end if the file was truncated under it. */
+	if(fd < MIN_FD || fd > MAX_FD || nbytes < 0) return -1;
+	file = &(pcb->file_array[fd]);
+	if(file->file_pos >= file_size(file)) return 0;
 
-	/* Read the data into the buffer */
-	count = read_data(pcb->file_array[fd].inode_num, pcb->file_array[fd].file_pos, (uint8_t*)buf, nbytes);
+	/* Read the data into the buffer, pages ahead of a sequential reader first */
+	file_readahead(file, nbytes);
+	count = read_data(file->inode_num, file->file_pos, (uint8_t*)buf, nbytes);
 	if(count == -1) return -1;
 
 	/* Increment the file position and return bytes copied */
-	pcb->file_array[fd].file_pos += count;
+	file->file_pos += count;
+	file->ra_pos = file->file_pos;
 	return count;
 }
 
+/* 
+ * file_readv(int32_t fd, const iovec_t* iov, int32_t iovcnt)
+ *   DESCRIPTION: reads from the file into several buffers, each one filled
+ *				  before the next, in one pass over the file
+ *   INPUTS: fd - the file descriptor
+ *			 iov - the buffers
+ *			 iovcnt - how many there are
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 if error and bytes copied on success
+ *   SIDE EFFECTS: increment file_pos in the file given by the fd, may read
+ *				   pages after it into the page cache
+ */
+int32_t file_readv(int32_t fd, const iovec_t* iov, int32_t iovcnt)
+{
+	pcb_t * pcb = get_pcb();
+	file_t * file;
+	int32_t i, count, total = 0, nbytes = 0;
+
+	if(fd < MIN_FD || fd > MAX_FD) return -1;
+	file = &(pcb->file_array[fd]);
+	for(i = 0; i < iovcnt; i++){
+		if(iov[i].base == NULL || iov[i].len < 0) return -1;
+		nbytes += iov[i].len;
+	}
+	if(file->file_pos >= file_size(file)) return 0;
+
+	/* One readahead decision for the whole vector */
+	file_readahead(file, nbytes);
+	for(i = 0; i < iovcnt; i++){
+		count = read_data(file->inode_num, file->file_pos, (uint8_t *)iov[i].base, iov[i].len);
+		if(count == -1) return (total == 0) ? -1 : total;
+		file->file_pos += count;
+		total += count;
+		if(count < iov[i].len) break;
+	}
+
+	file->ra_pos = file->file_pos;
+	return total;
+}
+
+/* 
+ * file_readahead(file_t * file, uint32_t nbytes)
+ *   DESCRIPTION: Reads the pages after a sequential read into the page
+ *				  cache. A read that starts where the last one ended is
+ *				  sequential, and once it gets into the back half of the
+ *				  pages read ahead the window doubles, from RA_MIN_PAGES
+ *				  up to RA_MAX_PAGES, and the next pages are read. Any
+ *				  other read starts the window over.
+ *   INPUTS: file - the open regular file about to be read
+ *			 nbytes - the size of the read
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: updates the readahead state of the file
+ */
+static void file_readahead(file_t * file, uint32_t nbytes)
+{
+	uint32_t first, last, start;
+
+	if(file->file_pos != file->ra_pos){
+		file->ra_window = 0;
+		file->ra_end = 0;
+		return;
+	}
+	if(nbytes == 0) return;
+
+	first = file->file_pos / BLOCK_SIZE;
+	last = (file->file_pos + nbytes - 1) / BLOCK_SIZE;
+	if(last + file->ra_window / 2 < file->ra_end) return;
+
+	file->ra_window = (file->ra_window == 0) ? RA_MIN_PAGES : 2 * file->ra_window;
+	if(file->ra_window > RA_MAX_PAGES) file->ra_window = RA_MAX_PAGES;
+	start = (file->ra_end > first) ? file->ra_end : first;
+	page_cache_readahead(file->inode_num, start, last + 1 + file->ra_window - start);
+	file->ra_end = last + 1 + file->ra_window;
+}
+
 /* 
  * file_write(int32_t fd, void* buf, int32_t nbytes)
- *   DESCRIPTION: NOTHING
+ *   DESCRIPTION: Writes a buffer into a file at the file position, growing
+ *				  the file when the write runs past its end. The data goes
+ *				  into the file's pages in the page cache, page_cache_sync
+ *				  copies it to the filesystem image later.
+ *   INPUTS: fd - the file descriptor
+ *			 const void* buf - pointer to data to write
+ *			 int32_t nbytes - the amount to write
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 if error and bytes written on success, short if the
+ *				   filesystem fills up
+ *   SIDE EFFECTS: may allocate data blocks, increments file_pos in the file
+ *				   given by the fd
+ */
+int32_t file_write(int32_t fd, const void* buf, int32_t nbytes)
+{
+	pcb_t * pcb = get_pcb();
+	uint32_t inode, pos, size, span, frame;
+	int32_t count = 0;
+
+	/* Check for a valid fd and a filesystem that can be written */
+	if(fd < MIN_FD || fd > MAX_FD || buf == NULL || nbytes < 0) return -1;
+	if(block_map == NULL) return -1;
+	inode = pcb->file_array[fd].inode_num;
+	pos = pcb->file_array[fd].file_pos;
+
+	/* Make room first so every page written lies inside the file */
+	size = grow_file(inode, pos + nbytes);
+	if(pos >= size) return (nbytes == 0) ? 0 : -1;
+	if(nbytes > size - pos) nbytes = size - pos;
+
+	while(count < nbytes){
+		span = BLOCK_SIZE - pos % BLOCK_SIZE;
+		if(span > nbytes - count) span = nbytes - count;
+
+		/* A full cache is made room in by writing the dirty pages back */
+		frame = page_cache_get(inode, pos / BLOCK_SIZE);
+		if(frame == 0 && page_cache_sync() > 0) frame = page_cache_get(inode, pos / BLOCK_SIZE);
+		if(frame == 0) break;
+
+		memcpy((uint8_t *)(frame + pos % BLOCK_SIZE), (uint8_t *)buf + count, span);
+		page_cache_dirty(frame);
+		page_cache_put(frame);
+		count += span;
+		pos += span;
+	}
+
+	pcb->file_array[fd].file_pos = pos;
+	return (count == 0 && nbytes > 0) ? -1 : count;
+}
+
+/* 
+ * dir_write(int32_t fd, void* buf, int32_t nbytes)
+ *   DESCRIPTION: NOTHING, the directory changes through fs_create
  *   INPUTS: fd - the file descriptor
  *			 const void* buf - pointer to data to write
  *			 int32_t nbytes - the amount to write
@@ -259,11 +693,163 @@ int32_t file_read(int32_t fd, void* buf, int32_t nbytes)
  *   RETURN VALUE: -1 always
  *   SIDE EFFECTS: nothing
  */
-int32_t file_write(int32_t fd, const void* buf, int32_t nbytes)
+int32_t dir_write(int32_t fd, const void* buf, int32_t nbytes)
 {
 	return -1;
 }
 
+/* 
+ * fs_create(const uint8_t* fname)
+ *   DESCRIPTION: Adds an empty regular file to the boot block with a free inode
+ *   INPUTS: fname - the name of the new file, at most MAX_NAME_SIZE characters
+ *   OUTPUTS: none
+ *   RETURN VALUE: 0 for success, -1 if the name is bad or taken or there is
+ *				   no free dentry or inode
+ *   SIDE EFFECTS: writes the boot block and an inode, may rebuild dentry_index
+ */
+int32_t fs_create(const uint8_t* fname)
+{
+	uint32_t flags, frames, len = strlen((int8_t *)fname);
+	int32_t inode;
+	dentry_t dentry;
+	dentry_t * d;
+
+	if(len == 0 || len > MAX_NAME_SIZE || block_map == NULL) return -1;
+
+	cli_and_save(flags);
+	if(num_dentries >= MAX_DENTRIES || 0 == read_dentry_by_name(fname, &dentry)){
+		restore_flags(flags);
+		return -1;
+	}
+	inode = alloc_bit(inode_map, num_inodes);
+	if(inode == -1){
+		restore_flags(flags);
+		return -1;
+	}
+
+	/* Empty file in a fresh inode, then the dentry after the last one */
+	*((uint32_t *) (file_addr + (inode + 1) * BLOCK_SIZE)) = 0;
+	d = (dentry_t *)(file_addr + (num_dentries + 1) * NUM_DIR_ENTRIES);
+	memset(d, 0, NUM_DIR_ENTRIES);
+	strncpy(d->file_name, (int8_t *)fname, MAX_NAME_SIZE);
+	d->file_type = STDOUT;
+	d->inode_num = inode;
+	num_dentries++;
+	*((uint32_t *)file_addr) = num_dentries;
+
+	/* Keep the index at most half full, a rebuild takes in the new dentry */
+	if(dentry_index != NULL && 2 * num_dentries > dentry_slots){
+		frames = (dentry_slots * PTR_SIZE + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		free_frames((uint32_t)dentry_index, frames);
+		build_dentry_index();
+	}
+	else if(dentry_index != NULL){
+		index_dentry(d);
+	}
+
+	restore_flags(flags);
+	return 0;
+}
+
+/* 
+ * fs_truncate(uint32_t inode, uint32_t length)
+ *   DESCRIPTION: Sets the length of a file, cutting it short gives its data
+ *				  blocks back and growing it adds zeroed ones
+ *   INPUTS: inode - the inode of the file
+ *			 length - the new length in bytes
+ *   OUTPUTS: none
+ *   RETURN VALUE: 0 for success, -1 if the filesystem cannot hold the length
+ *   SIDE EFFECTS: writes the inode, drops cached pages past the new end,
+ *				   pages still mapped by mmap keep their frames until munmap
+ */
+int32_t fs_truncate(uint32_t inode, uint32_t length)
+{
+	uint32_t * curr_inode;
+	uint32_t i, flags, blocks, new_blocks;
+
+	if(inode >= num_inodes || block_map == NULL) return -1;
+	curr_inode = (uint32_t *) (file_addr + (inode + 1) * BLOCK_SIZE);
+	if(length >= *curr_inode) return (grow_file(inode, length) == length) ? 0 : -1;
+
+	cli_and_save(flags);
+	blocks = (*curr_inode + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	new_blocks = (length + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	for(i = new_blocks; i < blocks; i++){
+		block_map[curr_inode[i + 1] / BITS_PER_LONG] &= ~(0x1 << (curr_inode[i + 1] % BITS_PER_LONG));
+		curr_inode[i + 1] = 0;
+	}
+	page_cache_invalidate(inode, new_blocks);
+	*curr_inode = length;
+	size_gen++;
+
+	/* Growing the file again has to read zeros past here */
+	zero_tail(inode, length);
+	restore_flags(flags);
+	return 0;
+}
+
+/* 
+ * grow_file(uint32_t inode, uint32_t length)
+ *   DESCRIPTION: Lengthens a file, new data blocks are zeroed in the image
+ *				  so they need no cache page until they are written
+ *   INPUTS: inode - the inode of the file
+ *			 length - the length wanted, files shorter than it are grown
+ *   OUTPUTS: none
+ *   RETURN VALUE: the length of the file afterwards, less than length if
+ *				   the blocks ran out
+ *   SIDE EFFECTS: takes data blocks and writes the inode
+ */
+static uint32_t grow_file(uint32_t inode, uint32_t length)
+{
+	uint32_t * curr_inode = (uint32_t *) (file_addr + (inode + 1) * BLOCK_SIZE);
+	uint32_t flags, blocks;
+	int32_t block;
+
+	cli_and_save(flags);
+	if(length > MAX_FILE_BLOCKS * BLOCK_SIZE) length = MAX_FILE_BLOCKS * BLOCK_SIZE;
+	if(length <= *curr_inode){
+		restore_flags(flags);
+		return *curr_inode;
+	}
+
+	zero_tail(inode, *curr_inode);
+	for(blocks = (*curr_inode + BLOCK_SIZE - 1) / BLOCK_SIZE; blocks < (length + BLOCK_SIZE - 1) / BLOCK_SIZE; blocks++){
+		block = alloc_bit(block_map, num_blocks);
+		if(block == -1){
+			length = blocks * BLOCK_SIZE;
+			break;
+		}
+		memset((void *)(file_addr + (block + num_inodes + 1) * BLOCK_SIZE), 0, BLOCK_SIZE);
+		curr_inode[blocks + 1] = block;
+	}
+	*curr_inode = length;
+	size_gen++;
+
+	restore_flags(flags);
+	return length;
+}
+
+/* 
+ * zero_tail(uint32_t inode, uint32_t size)
+ *   DESCRIPTION: Clears the rest of the last data block of a file past its
+ *				  end, in the image and in a cached copy of the page
+ *   INPUTS: inode - the inode of the file
+ *			 size - the length of the file
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: writes the data block
+ */
+static void zero_tail(uint32_t inode, uint32_t size)
+{
+	uint32_t block, frame;
+
+	if(size % BLOCK_SIZE == 0) return;
+	block = file_block(inode, size / BLOCK_SIZE);
+	if(block != 0) memset((void *)(block + size % BLOCK_SIZE), 0, BLOCK_SIZE - size % BLOCK_SIZE);
+	frame = page_cache_find(inode, size / BLOCK_SIZE);
+	if(frame != 0) memset((void *)(frame + size % BLOCK_SIZE), 0, BLOCK_SIZE - size % BLOCK_SIZE);
+}
+
 /* 
  * file_open(const uint8_t filename)
  *   DESCRIPTION: NA
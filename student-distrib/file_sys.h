@@ -21,6 +21,16 @@
 #define NUM_FSYS_PAGES 124
 #define MAX_FD 7
 #define MIN_FD 2
+#define FNV_OFFSET 2166136261U	/* FNV-1a starting hash */
+#define FNV_PRIME 16777619		/* FNV-1a multiplier */
+#define PTR_SIZE 4
+#define MAX_DENTRIES (BLOCK_SIZE / NUM_DIR_ENTRIES - 1)	/* Dentries that fit after the boot block's counts */
+#define MAX_FILE_BLOCKS (BLOCK_SIZE / NIB_SIZE - 1)		/* Data block numbers an inode holds after the length */
+#define MAP_BITS (BLOCK_SIZE * 8)						/* Blocks or inodes one bitmap frame covers */
+#define RA_MIN_PAGES 2			/* Readahead window once a file is read sequentially */
+#define RA_MAX_PAGES 32			/* The window doubles on each sequential read up to this */
+#define TEST_BUF_SIZE (3 * BLOCK_SIZE)	/* Largest read done by read_data_test */
+#define NUM_TEST_CASES 8				/* Offsets and lengths tried by read_data_test */
 
 extern fops_t file_file_operations;
 extern fops_t dir_file_operations;
@@ -31,11 +41,22 @@ int32_t read_data (uint32_t inode, uint32_t offset, uint8_t* buf, uint32_t lengt
 
 void init_file_sys(module_t * mod);
 int32_t file_read(int32_t fd, void* buf, int32_t nbytes);
+int32_t file_readv(int32_t fd, const iovec_t* iov, int32_t iovcnt);
 int32_t file_write(int32_t fd, const void* buf, int32_t nbytes);
+int32_t dir_write(int32_t fd, const void* buf, int32_t nbytes);
+int32_t fs_create(const uint8_t* fname);
+int32_t fs_truncate(uint32_t inode, uint32_t length);
 int32_t file_open(const uint8_t* filename);
 int32_t dir_open(const uint8_t* filename);
 int32_t file_close(int32_t fd);
 int32_t read_directory(int32_t fd, void* buf, int32_t nbytes);
+int32_t read_dirents(int32_t fd, dirent_t* buf, int32_t nbytes);
 int32_t read_size (uint32_t inode);
+uint32_t file_size(file_t * file);
+void cache_file_size(file_t * file);
+uint32_t file_block(uint32_t inode, uint32_t index);
+#ifdef FS_SELF_TEST
+int32_t read_data_test(void);
+#endif
 
 #endif /* _FILE_SYS_H */
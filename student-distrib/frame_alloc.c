@@ -0,0 +1,256 @@
+/*
+* frame_alloc.c - hands out 4 KB physical page frames for page directories,
+*				  page tables and user memory
+* @Author: Jack Weil, Charles Zega, Rahul Sharma, Saurav Puri
+* @Date:   2016-12-05 14:10:00
+* @Last Modified by:   Jack
+* @Last Modified time: 2016-12-05 14:10:00
+*/
+
+#include "frame_alloc.h"
+
+/* Bit n is set when frame n is in use or does not exist */
+static uint32_t frame_map[FRAME_MAP_SIZE];
+static uint32_t frames_free;
+
+/* The number of extra mappings of each frame, frames shared copy-on-write
+   only go back to the free map when the last one is dropped */
+static uint8_t frame_refs[NUM_FRAMES];
+
+static void mark_range(uint32_t start, uint32_t end, int used);
+
+/* 
+ * init_frame_alloc(multiboot_info_t * mbi)
+ *   DESCRIPTION: Marks every frame used, then frees the ones the multiboot
+ *				  memory map reports as RAM, and takes the modules back out
+ *   INPUTS: mbi - the multiboot info passed to entry
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Must run before paging is enabled, reads low memory directly
+ */
+void init_frame_alloc(multiboot_info_t * mbi)
+{
+	int i;
+	memory_map_t * mmap;
+	module_t * mod;
+
+	for(i = 0; i < FRAME_MAP_SIZE; i++){
+		frame_map[i] = 0xFFFFFFFF;
+	}
+	frames_free = 0;
+
+	/* Free usable RAM from the memory map, or from mem_upper without one */
+	if(mbi->flags & (0x1 << MB_MMAP_FLAG)){
+		for(mmap = (memory_map_t *)mbi->mmap_addr;
+				(uint32_t)mmap < mbi->mmap_addr + mbi->mmap_length;
+				mmap = (memory_map_t *)((uint32_t)mmap + mmap->size + sizeof(mmap->size))){
+			if(mmap->type != MMAP_AVAILABLE || mmap->base_addr_high != 0) continue;
+			if(mmap->length_high != 0 || mmap->base_addr_low + mmap->length_low < mmap->base_addr_low){
+				mark_range(mmap->base_addr_low, FRAME_LIMIT, 0);
+			}
+			else{
+				mark_range(mmap->base_addr_low, mmap->base_addr_low + mmap->length_low, 0);
+			}
+		}
+	}
+	else if(mbi->flags & (0x1 << MB_MEM_FLAG)){
+		mark_range(ONE_MB, ONE_MB + mbi->mem_upper * ONE_KB, 0);
+	}
+
+	/* Never hand out the filesystem image or any other module */
+	if(mbi->flags & (0x1 << MB_MODS_FLAG)){
+		mod = (module_t *)mbi->mods_addr;
+		for(i = 0; i < mbi->mods_count; i++, mod++){
+			mark_range(mod->mod_start, mod->mod_end, 1);
+		}
+	}
+}
+
+/* 
+ * mark_range(uint32_t start, uint32_t end, int used)
+ *   DESCRIPTION: Marks the whole frames between two physical addresses, clipped
+ *				  to [FRAME_BASE, FRAME_LIMIT). Free ranges shrink to whole frames,
+ *				  used ranges grow to whole frames.
+ *   INPUTS: start - first byte of the range
+ *			 end - one past the last byte of the range
+ *			 used - 1 to mark in use, 0 to mark free
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Changes the frame map and free count
+ */
+static void mark_range(uint32_t start, uint32_t end, int used)
+{
+	uint32_t frame, last;
+
+	if(used){
+		frame = start >> FRAME_SHIFT;
+		last = (end + FRAME_SIZE - 1) >> FRAME_SHIFT;
+	}
+	else{
+		frame = (start + FRAME_SIZE - 1) >> FRAME_SHIFT;
+		last = end >> FRAME_SHIFT;
+	}
+	if(frame < (FRAME_BASE >> FRAME_SHIFT)) frame = FRAME_BASE >> FRAME_SHIFT;
+	if(last > NUM_FRAMES) last = NUM_FRAMES;
+
+	for(; frame < last; frame++){
+		if(used && !(frame_map[frame / BITS_PER_LONG] & (0x1 << (frame % BITS_PER_LONG)))){
+			frame_map[frame / BITS_PER_LONG] |= 0x1 << (frame % BITS_PER_LONG);
+			frames_free--;
+		}
+		else if(!used && (frame_map[frame / BITS_PER_LONG] & (0x1 << (frame % BITS_PER_LONG)))){
+			frame_map[frame / BITS_PER_LONG] &= ~(0x1 << (frame % BITS_PER_LONG));
+			frames_free++;
+		}
+	}
+}
+
+/* 
+ * alloc_frame(void)
+ *   DESCRIPTION: Takes one free frame, searching down from the top of memory
+ *				  so single frames do not break up the 4 MB runs near the bottom
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: physical address of the frame, 0 if memory is full
+ *   SIDE EFFECTS: Marks the frame used, the contents are not cleared
+ */
+uint32_t alloc_frame(void)
+{
+	int i, bit;
+	uint32_t flags;
+
+	cli_and_save(flags);
+	for(i = FRAME_MAP_SIZE - 1; i >= (FRAME_BASE >> FRAME_SHIFT) / BITS_PER_LONG; i--){
+		if(frame_map[i] == 0xFFFFFFFF) continue;
+		for(bit = BITS_PER_LONG - 1; bit >= 0; bit--){
+			if(!(frame_map[i] & (0x1 << bit))){
+				frame_map[i] |= 0x1 << bit;
+				frames_free--;
+				restore_flags(flags);
+				return (i * BITS_PER_LONG + bit) << FRAME_SHIFT;
+			}
+		}
+	}
+	restore_flags(flags);
+	return 0;
+}
+
+/* 
+ * alloc_frames(uint32_t count, uint32_t align)
+ *   DESCRIPTION: Takes a physically contiguous run of free frames, searching
+ *				  up from the bottom of memory
+ *   INPUTS: count - the number of frames in the run
+ *			 align - the run starts on a multiple of this many frames
+ *   OUTPUTS: none
+ *   RETURN VALUE: physical address of the first frame, 0 if no run fits
+ *   SIDE EFFECTS: Marks the frames used, the contents are not cleared
+ */
+uint32_t alloc_frames(uint32_t count, uint32_t align)
+{
+	uint32_t start, frame, flags;
+
+	if(count == 0) return 0;
+	if(align == 0) align = 1;
+
+	cli_and_save(flags);
+	start = FRAME_BASE >> FRAME_SHIFT;
+	start = (start + align - 1) / align * align;
+	while(start + count <= NUM_FRAMES){
+		/* Look for a used frame in the candidate run */
+		for(frame = start; frame < start + count; frame++){
+			if(frame_map[frame / BITS_PER_LONG] & (0x1 << (frame % BITS_PER_LONG))) break;
+		}
+		if(frame == start + count){
+			for(frame = start; frame < start + count; frame++){
+				frame_map[frame / BITS_PER_LONG] |= 0x1 << (frame % BITS_PER_LONG);
+			}
+			frames_free -= count;
+			restore_flags(flags);
+			return start << FRAME_SHIFT;
+		}
+
+		/* Restart at the next aligned frame past the used one */
+		start = (frame / align + 1) * align;
+	}
+	restore_flags(flags);
+	return 0;
+}
+
+/* 
+ * free_frame(uint32_t addr)
+ *   DESCRIPTION: Gives one frame back
+ *   INPUTS: addr - physical address of the frame
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Marks the frame free
+ */
+void free_frame(uint32_t addr)
+{
+	free_frames(addr, 1);
+}
+
+/* 
+ * free_frames(uint32_t addr, uint32_t count)
+ *   DESCRIPTION: Gives a run of frames from alloc_frames back, a frame that
+ *				  is still shared only loses one of its mappings
+ *   INPUTS: addr - physical address of the first frame
+ *			 count - the number of frames in the run
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Marks the frames free
+ */
+void free_frames(uint32_t addr, uint32_t count)
+{
+	uint32_t flags, frame;
+
+	cli_and_save(flags);
+	for(frame = addr >> FRAME_SHIFT; frame < (addr >> FRAME_SHIFT) + count && frame < NUM_FRAMES; frame++){
+		if(frame_refs[frame] > 0) frame_refs[frame]--;
+		else mark_range(frame << FRAME_SHIFT, (frame + 1) << FRAME_SHIFT, 0);
+	}
+	restore_flags(flags);
+}
+
+/* 
+ * share_frame(uint32_t addr)
+ *   DESCRIPTION: Records one more mapping of a frame, it then takes one
+ *				  more free_frame to give it back
+ *   INPUTS: addr - physical address of the frame
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Changes the frame's reference count
+ */
+void share_frame(uint32_t addr)
+{
+	uint32_t flags;
+
+	cli_and_save(flags);
+	frame_refs[addr >> FRAME_SHIFT]++;
+	restore_flags(flags);
+}
+
+/* 
+ * frame_sharers(uint32_t addr)
+ *   DESCRIPTION: Gets the number of mappings of a frame besides the first
+ *   INPUTS: addr - physical address of the frame
+ *   OUTPUTS: none
+ *   RETURN VALUE: 0 if only one mapping is left
+ *   SIDE EFFECTS: none
+ */
+uint32_t frame_sharers(uint32_t addr)
+{
+	return frame_refs[addr >> FRAME_SHIFT];
+}
+
+/* 
+ * free_frame_count(void)
+ *   DESCRIPTION: Gets the number of frames that are free
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: the number of free frames
+ *   SIDE EFFECTS: none
+ */
+uint32_t free_frame_count(void)
+{
+	return frames_free;
+}
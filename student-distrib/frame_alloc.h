@@ -0,0 +1,40 @@
+/*
+* frame_alloc.h - header file for frame_alloc.c
+* @Author: Jack Weil, Charles Zega, Rahul Sharma, Saurav Puri
+* @Date:   2016-12-05 14:10:00
+* @Last Modified by:   Jack
+* @Last Modified time: 2016-12-05 14:10:00
+*/
+
+#ifndef _FRAME_ALLOC_H
+#define _FRAME_ALLOC_H
+
+#include "types.h"
+#include "lib.h"
+#include "multiboot.h"
+
+#define FRAME_SIZE 4096				/* Bytes in one physical frame */
+#define FRAME_SHIFT 12				/* Bit shift from an address to a frame number */
+#define FRAME_BASE 0x800000			/* Frames below 8 MB belong to the kernel image and PCBs */
+#define FRAME_LIMIT 0x8000000		/* Frames at or above 128 MB are never handed out */
+#define NUM_FRAMES (FRAME_LIMIT >> FRAME_SHIFT)
+#define BITS_PER_LONG 32
+#define FRAME_MAP_SIZE (NUM_FRAMES / BITS_PER_LONG)
+#define FRAMES_PER_4MB 1024
+#define MMAP_AVAILABLE 1			/* Multiboot memory map type for usable RAM */
+#define ONE_MB 0x100000
+#define ONE_KB 1024
+#define MB_MEM_FLAG 0				/* Multiboot flag bit for mem_lower/mem_upper */
+#define MB_MODS_FLAG 3				/* Multiboot flag bit for the module list */
+#define MB_MMAP_FLAG 6				/* Multiboot flag bit for the memory map */
+
+void init_frame_alloc(multiboot_info_t * mbi);
+uint32_t alloc_frame(void);
+uint32_t alloc_frames(uint32_t count, uint32_t align);
+void free_frame(uint32_t addr);
+void free_frames(uint32_t addr, uint32_t count);
+uint32_t free_frame_count(void);
+void share_frame(uint32_t addr);
+uint32_t frame_sharers(uint32_t addr);
+
+#endif /* _FRAME_ALLOC_H */
@@ -0,0 +1,37 @@
+#!/bin/sh
+# idle_cpu.sh - boot mp3.img in QEMU, leave the shell sitting at its prompt,
+# and report how much host CPU the VM uses while the guest is idle.
+# Run after "sudo make" has built mp3.img. Usage: ./idle_cpu.sh [seconds]
+
+SECS=${1:-20}
+SETTLE=10
+QEMU=${QEMU:-qemu-system-i386}
+HZ=$(getconf CLK_TCK)
+
+if [ ! -f ./mp3.img ]; then
+	echo "mp3.img not found, build it first"
+	exit 1
+fi
+
+# Boot headless from a scratch copy so the real image is untouched
+cp ./mp3.img /tmp/idle_cpu.img
+$QEMU -hda /tmp/idle_cpu.img -m 128 -display none &
+PID=$!
+
+# Let the kernel boot and the first shell reach its prompt
+sleep $SETTLE
+
+# utime + stime of the QEMU process, in clock ticks
+cpu_ticks() {
+	awk '{ print $14 + $15 }' /proc/$PID/stat
+}
+
+START=$(cpu_ticks)
+sleep $SECS
+END=$(cpu_ticks)
+
+kill $PID
+wait $PID 2>/dev/null
+rm -f /tmp/idle_cpu.img
+
+echo "host CPU used by idle VM: $(( (END - START) * 100 / (HZ * SECS) ))% of one core over ${SECS}s"
@@ -75,7 +75,7 @@ void init_idt(void)
 	SET_IDT_ENTRY(idt[SEGMENT_NOT_PRESENT],segment_not_present);
 	SET_IDT_ENTRY(idt[STACK_SEGMENT],stack_segment);
 	SET_IDT_ENTRY(idt[GENERAL_PROTECTION],general_protection);
-	SET_IDT_ENTRY(idt[PAGE_FAULT],page_fault);
+	SET_IDT_ENTRY(idt[PAGE_FAULT],asm_page_fault_handler);
 	SET_IDT_ENTRY(idt[COPROCESSOR_ERROR],coprocessor_error);
 	SET_IDT_ENTRY(idt[ALIGNMENT_CHECK],alignment_check);
 	SET_IDT_ENTRY(idt[MACHINE_CHECK],machine_check);
@@ -86,6 +86,7 @@ void init_idt(void)
 	SET_IDT_ENTRY(idt[KEYBOARD],asm_keyboard_handler);
 	SET_IDT_ENTRY(idt[RTC],asm_rtc_handler);
 	SET_IDT_ENTRY(idt[TIMER],asm_timer_handler);
+	SET_IDT_ENTRY(idt[YIELD],asm_yield_handler);
 }
 
 /* 
@@ -28,6 +28,7 @@
 #define KEYBOARD 0x21
 #define RTC 	 0x28
 #define TIMER    0x20
+#define YIELD    0x81
 #define TIMER_IRQ 0
 
 /* Function primitives */
@@ -15,6 +15,7 @@
 #include "file_sys.h"
 #include "syscall.h"
 #include "scheduling.h"
+#include "scrollback.h"
 
 /* Macros. */
 /* Check if the bit BIT in FLAGS is set. */
@@ -163,20 +164,23 @@ entry (unsigned long magic, unsigned long addr)
 	i8259_init();
 	keyboard_init();
 	rtc_init();
+	init_sysenter();
+	init_frame_alloc(mbi);
 	init_paging();
+	scrollback_init();
 	init_file_sys(faddr);
+#ifdef FS_SELF_TEST
+	read_data_test();
+#endif
 	term_init();
 	init_timer();
 
 	/* Execute the first program (`shell') ... */
-	sys_fork();
+	spawn_shell();
 
-	/* Enable interrupts */
+	/* Enable interrupts, the first timer tick leaves this context for good */
 	sti();
 
-	/* Loop forever, should never reach here */
-	while(1 == 1);
-
 	/* Spin (nicely, so we don't chew up cycles) */
 	asm volatile(".1: hlt; jmp .1;");
 }
@@ -37,12 +37,16 @@ static int SHIFTR_FLAG;
 static int CAPS_FLAG;
 static int ENTER_FLAG[NUM_TERMS];
 static int ALT_FLAG;
+static int EXT_FLAG;
 
 /* Holds the input string to help utilize line-buffered input */
 static char command_line[NUM_TERMS][BUFFER_SIZE];
 static int cl_index[NUM_TERMS];
 static int active_term;
 
+/* Tasks blocked in key_read for each terminal, woken by ENTER */
+static wait_queue_t key_wait[NUM_TERMS];
+
 /* 
  * keyboard_init()
  *   DESCRIPTION: Initialize all the information necessary for the keyboard
@@ -63,6 +67,8 @@ void keyboard_init(void)
 		}
 		cl_index[i] = 0;
 		ENTER_FLAG[i] = 0;
+		key_wait[i].head = NULL;
+		key_wait[i].tail = NULL;
 	}
 
 	/* Start writing in zeroth position */
@@ -88,7 +94,8 @@ int key_valid(keycode)
 {
 	if((keycode > 0x01 && keycode < 0x0F) || (keycode > 0x0F && keycode < 0x37) || 
 		(keycode > 0x37 && keycode < 0x3B) || keycode == 0x9D || keycode == 0xAA ||
-		keycode == 0xB6 || keycode == 0xB8 || keycode == 0xBA)
+		keycode == 0xB6 || keycode == 0xB8 || keycode == 0xBA || keycode == PGUP_DOWN ||
+		keycode == PGDN_DOWN)
 	{
 		return 1;
 	}
@@ -109,6 +116,21 @@ void keyboard_handler(void)
 {
 	/* Get the scancode from the keyboard */
 	int keycode = inb(DATA_PORT);
+	int extended = EXT_FLAG;
+
+	/* The next scancode is for an extended key */
+	EXT_FLAG = 0;
+	if(keycode == EXT_CODE){
+		EXT_FLAG = 1;
+		send_eoi(LOC_OF_KEYBOARD);
+		return;
+	}
+
+	/* The grey keys send a fake shift along with them, it is not a real one */
+	if(extended && (keycode == SHIFT_DOWN || keycode == SHIFT_UP)){
+		send_eoi(LOC_OF_KEYBOARD);
+		return;
+	}
 
 	/* Alt-fxn check */
 	if(ALT_FLAG && keycode != ALT_UP && keycode != ALT_DOWN && keycode != CTL_DOWN && keycode != CTL_UP && \
@@ -161,6 +183,15 @@ void keyboard_handler(void)
 		case(SHIFTR_UP):
 			SHIFTR_FLAG = 0;
 			break;
+		case(PGUP_DOWN):
+		case(PGDN_DOWN):
+			/* Shift+PgUp/PgDn moves through the history a screen at a time. Keypad
+			   9 and 3 send the same codes without the prefix and are still ignored. */
+			if(extended && (SHIFT_FLAG || SHIFTR_FLAG)){
+				scrollback_view(active_term, (keycode == PGUP_DOWN) ? NUM_ROWS - 1 : 1 - NUM_ROWS);
+			}
+			send_eoi(LOC_OF_KEYBOARD);
+			return;
 		case(BACKSPACE):
 			if(cl_index[active_term] == 0)
 				break;
@@ -181,6 +212,8 @@ void keyboard_handler(void)
 				cl_index[active_term] = 0;
 			}
 			ENTER_FLAG[active_term] = 0;
+
+			wake_up(&key_wait[active_term]);
 			break;
 		default:
 			if(keycode > TYPED){
@@ -211,6 +244,12 @@ void keyboard_handler(void)
 			}
 	}
 
+	/* Typing goes back to the live screen */
+	if(keycode <= TYPED && keycode != CTL_DOWN && keycode != SHIFT_DOWN && keycode != SHIFTR_DOWN &&
+		keycode != ALT_DOWN && keycode != CAPS_DOWN){
+		scrollback_end(active_term);
+	}
+
 	/* Output to the screen and exit */
 	keyboard_put();
 	send_eoi(LOC_OF_KEYBOARD);
@@ -229,6 +268,7 @@ void keyboard_put(void)
 {
 	/* Loop counter */
 	int i, j, x;
+	uint8_t * video;
 	j = 0;
 
 	/* Cast buf to a char ptr */
@@ -239,7 +279,7 @@ void keyboard_put(void)
 	pcb_t * old_pcb = get_pcb();
 	for(i = 1; i < MAX_PROCESSES; i++){
 		pcb = (pcb_t *)(EIGHT_MB - i*EIGHT_KB);
-		if(pcb->term == active_term && pcb->child == NULL) break;
+		if(task_running(i) && pcb->term == active_term && pcb->child == NULL) break;
 	}
 
 	/* Swipswap screenx/y values if curr process in inactive term */
@@ -252,6 +292,7 @@ void keyboard_put(void)
 
 	/* Switch to addr space of curr process */
 	set_page_directory(pcb->task_id);
+	video = text_base();
 
 	/* Move to video memory */
 	for(x = screen_x, i = 0; i < BUF_SIZE; x++, i++){
@@ -263,27 +304,28 @@ void keyboard_put(void)
 
 		/* Check for enter(newline) or scroll */
 		if(addr[i] == '\n'){
-			*(uint8_t *)(VIDEO + ((NUM_COLS*(screen_y + j) + x) << 1)) = '\0';
-	        *(uint8_t *)(VIDEO + ((NUM_COLS*(screen_y + j) + x) << 1) + 1) = ATTRIB; 
+			*(video + ((NUM_COLS*(screen_y + j) + x) << 1)) = '\0';
+	        *(video + ((NUM_COLS*(screen_y + j) + x) << 1) + 1) = ATTRIB; 
 			screen_y = screen_y + j + 1;
 			screen_x = 0;
 			break;
 		} else if(screen_y + j > NUM_ROWS-1){
 			vert_scroll();
+			video = text_base();
 			screen_y = NUM_ROWS - j - 1;
 		}
 
 		/* Output the char to video memory */
-		*(uint8_t *)(VIDEO + ((NUM_COLS*(screen_y + j) + x) << 1)) = addr[i];
-        *(uint8_t *)(VIDEO + ((NUM_COLS*(screen_y + j) + x) << 1) + 1) = ATTRIB; 
+		*(video + ((NUM_COLS*(screen_y + j) + x) << 1)) = addr[i];
+        *(video + ((NUM_COLS*(screen_y + j) + x) << 1) + 1) = ATTRIB; 
 
         /* If null char stop writing to vidmem */
         if(addr[i] == '\0')
         {
-        	*(uint8_t *)(VIDEO + ((NUM_COLS*(screen_y + j) + x) << 1)) = BLOCK_TXT;
-	        *(uint8_t *)(VIDEO + ((NUM_COLS*(screen_y + j) + x) << 1) + 1) = ATTRIB; 
-	        *(uint8_t *)(VIDEO + ((NUM_COLS*(screen_y + j) + x + 1) << 1)) = '\0';
-	        *(uint8_t *)(VIDEO + ((NUM_COLS*(screen_y + j) + x + 1) << 1) + 1) = ATTRIB; 
+        	*(video + ((NUM_COLS*(screen_y + j) + x) << 1)) = BLOCK_TXT;
+	        *(video + ((NUM_COLS*(screen_y + j) + x) << 1) + 1) = ATTRIB; 
+	        *(video + ((NUM_COLS*(screen_y + j) + x + 1) << 1)) = '\0';
+	        *(video + ((NUM_COLS*(screen_y + j) + x + 1) << 1) + 1) = ATTRIB; 
         	break;
         }
 	}
@@ -322,11 +364,10 @@ int32_t key_read(int32_t fd, void* buf, int32_t nbytes)
 	/* Null ptr check */
 	if(buf == NULL) return -1;
 
-	/* Block until the enter key has been pressed */
-	ENTER_FLAG[pcb->term] = 1;
-	sti();
-	while(ENTER_FLAG[pcb->term]);
+	/* Sleep until the enter key has been pressed */
 	cli();
+	ENTER_FLAG[pcb->term] = 1;
+	while(ENTER_FLAG[pcb->term]) sleep_on(&key_wait[pcb->term]);
 	
 	/* Copy the local buffer into parameter buf */
 	for(i = 0; (i < BUFFER_SIZE && i < nbytes-1); i++){
@@ -407,7 +448,7 @@ void clear_keyboard(void)
 	cli();
 	for(i = 1; i < MAX_PROCESSES; i++){
 		pcb = (pcb_t *)(EIGHT_MB - i*EIGHT_KB);
-		if(pcb->term == active_term && pcb->child == NULL) break;
+		if(task_running(i) && pcb->term == active_term && pcb->child == NULL) break;
 	}
 
 	/* Swipswap screenx/y values if curr process in inactive term */
@@ -11,6 +11,7 @@
 #include "i8259.h"
 #include "lib.h"
 #include "terminal.h"
+#include "scrollback.h"
 
 /* Info for accessing keyboard */
 #define DATA_PORT 0x60
@@ -38,6 +39,9 @@
 #define ALT_DOWN   0x38
 #define ALT_UP	   0xB8
 #define F1_DOWN    0x3B
+#define PGUP_DOWN  0x49
+#define PGDN_DOWN  0x51
+#define EXT_CODE   0xE0		/* Comes before the scancode of an extended key */
 
 
 void keyboard_init(void);
@@ -3,16 +3,27 @@
  */
 
 #include "lib.h"
+#include "scrollback.h"
 #define VIDEO 0xB8000
 #define NUM_COLS 80
 #define NUM_ROWS 25
+#define CRTC_ADDR 0x3D4			/* CRT controller index port */
+#define CRTC_DATA 0x3D5			/* CRT controller data port */
+#define CRTC_START_HI 0x0C		/* Start address high byte, in characters */
+#define CRTC_START_LO 0x0D		/* Start address low byte */
+#define CR0_PG 0x80000000		/* Paging is on */
 
 int screen_x;
 int screen_y;
 static char* video_mem = (char *)VIDEO;
 
+/* The text row shown at the top of the screen in each text region, and
+   the region on the display */
+static int text_top[TEXT_REGIONS];
+static uint32_t shown_region;
+
 /* Error message for attempting too many processes */
-char err_proc[128] = "fourDudes OS does not yet support more than 6 processes.\nThank you for choosing fourDudes OS.\n";
+char err_proc[128] = "fourDudes OS does not have room for another process.\nThank you for choosing fourDudes OS.\n";
 
 /*
 * void clear(void);
@@ -25,6 +36,11 @@ void
 clear(void)
 {
     int32_t i;
+    uint32_t region = text_region();
+
+    /* Start the region over at its first row */
+    text_top[region] = 0;
+    if(region == shown_region) show_text(region);
     for(i=0; i<NUM_ROWS*NUM_COLS; i++) {
         *(uint8_t *)(video_mem + (i << 1)) = ' ';
         *(uint8_t *)(video_mem + (i << 1) + 1) = ATTRIB;
@@ -189,12 +205,14 @@ puts(int8_t* s)
 void
 putc(uint8_t c)
 {
+    uint8_t * video = text_base();
+
     if(c == '\n' || c == '\r') {
         screen_y++;
         screen_x=0;
     } else {
-        *(uint8_t *)(video_mem + ((NUM_COLS*screen_y + screen_x) << 1)) = c;
-        *(uint8_t *)(video_mem + ((NUM_COLS*screen_y + screen_x) << 1) + 1) = ATTRIB;
+        *(video + ((NUM_COLS*screen_y + screen_x) << 1)) = c;
+        *(video + ((NUM_COLS*screen_y + screen_x) << 1) + 1) = ATTRIB;
         screen_x++;
         screen_x %= NUM_COLS;
         screen_y = (screen_y + (screen_x / NUM_COLS)) % NUM_ROWS;
@@ -564,8 +582,9 @@ void
 test_interrupts(void)
 {
 	int32_t i;
+	uint8_t * video = text_base();
 	for (i=0; i < NUM_ROWS*NUM_COLS; i++) {
-		video_mem[i<<1]++;
+		video[i<<1]++;
 	}
 }
 
@@ -590,23 +609,165 @@ void set_screen(int x, int y)
  *   INPUTS: none
  *   OUTPUTS: none
  *   RETURN VALUE: none
- *   SIDE EFFECTS: shift video memory
+ *   SIDE EFFECTS: same as vert_scroll_lines
  */
 void vert_scroll(void)
 {
-	/* Swap variable and loop counters */
-	uint8_t temp = '\0';
-	int x, y;
-
-	/* Loop through video memory and shift up one position */
-	for(x = 0; x < NUM_COLS; x++){
-		for(y = 0; y < NUM_ROWS-1; y++){
-			temp = *(uint8_t *)(VIDEO + ((NUM_COLS*(y+1) + x) << 1));
-			*(uint8_t *)(VIDEO + ((NUM_COLS*y + x) << 1)) = temp;
-        	*(uint8_t *)(VIDEO + ((NUM_COLS*y + x) << 1) + 1) = ATTRIB; 
-		}
-		/* Clear the bottom line of video memory */
-		*(uint8_t *)(VIDEO + ((NUM_COLS*y + x) << 1)) = '\0';
-    	*(uint8_t *)(VIDEO + ((NUM_COLS*y + x) << 1) + 1) = ATTRIB; 
+	vert_scroll_lines(1);
+}
+
+/* 
+ * vert_scroll_lines(int lines)
+ *   DESCRIPTION: shift the text mode screen up by some lines at once by
+ *				  moving where the screen starts in its text region down.
+ *				  When the region runs out the rows that stay on screen go
+ *				  back to its start, at most once every TEXT_ROWS - NUM_ROWS
+ *				  scrolled lines.
+ *   INPUTS: lines - how many lines to scroll, a full screen or more
+ *					 leaves it blank
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: clears the new bottom lines, adds the lines that leave
+ *				   to the terminal's scrollback, moves the display start if
+ *				   the region is the one on the display
+ */
+void vert_scroll_lines(int lines)
+{
+	uint32_t region = text_region();
+	int i, top = text_top[region];
+	uint8_t * line;
+
+	if(lines <= 0) return;
+
+	/* Keep the lines leaving the top of the screen. Past a whole screen
+	   the history gets blank lines, which the caller can fill in. */
+	for(i = 0; i < lines; i++){
+		line = scrollback_push(region);
+		if(line == NULL) break;
+		if(i < NUM_ROWS) memcpy(line, (void *)(VIDEO + (top + i) * ROW_BYTES), ROW_BYTES);
+		else memset_word(line, ATTRIB << 8, NUM_COLS);
+	}
+	if(lines > NUM_ROWS) lines = NUM_ROWS;
+
+	if(top + NUM_ROWS + lines <= TEXT_ROWS){
+		top += lines;
+	}
+	else{
+		memmove((void *)VIDEO, (void *)(VIDEO + (top + lines) * ROW_BYTES), (NUM_ROWS - lines) * ROW_BYTES);
+		top = 0;
 	}
+
+	/* Clear the bottom lines of the screen */
+	memset_word((void *)(VIDEO + (top + NUM_ROWS - lines) * ROW_BYTES), ATTRIB << 8, lines * NUM_COLS);
+	text_top[region] = top;
+	if(region == shown_region) show_text(region);
+}
+
+/* 
+ * text_region(void)
+ *   DESCRIPTION: Finds which text region VIDEO points at in the current
+ *				  address space, by reading the PTE through CR3
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: the terminal whose text region it is
+ *   SIDE EFFECTS: none
+ */
+uint32_t text_region(void)
+{
+	uint32_t cr0, cr3, pte;
+
+	asm volatile("movl %%cr0, %0\n\t"
+			"movl %%cr3, %1"
+			: "=r"(cr0), "=r"(cr3));
+
+	/* Before paging is on everything writes the screen */
+	if(!(cr0 & CR0_PG)) return 0;
+
+	/* Directories and the first table are at their physical address */
+	pte = ((uint32_t *)(((uint32_t *)cr3)[0] & ~0xFFF))[VIDEO >> 12];
+	return ((pte & ~0xFFF) - VIDEO) / TEXT_BYTES;
+}
+
+/* 
+ * text_base(void)
+ *   DESCRIPTION: Finds where the screen being written starts in VIDEO,
+ *				  the row at the top of it goes at y = 0
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: the address of the character at x = 0, y = 0
+ *   SIDE EFFECTS: none
+ */
+uint8_t * text_base(void)
+{
+	return (uint8_t *)(VIDEO + text_top[text_region()] * ROW_BYTES);
+}
+
+/* 
+ * text_row(uint32_t region, int y)
+ *   DESCRIPTION: Finds a row of a region's screen where the kernel's page
+ *				  directory sees it, every region at its own address
+ *   INPUTS: region - the terminal
+ *			 y - the row on its screen
+ *   OUTPUTS: none
+ *   RETURN VALUE: the address of the row
+ *   SIDE EFFECTS: none
+ */
+uint8_t * text_row(uint32_t region, int y)
+{
+	return (uint8_t *)(VIDEO + region * TEXT_BYTES + (text_top[region] + y) * ROW_BYTES);
+}
+
+/* 
+ * text_home(void)
+ *   DESCRIPTION: Moves the rows on the screen being written back to the
+ *				  start of its text region, for programs that draw straight
+ *				  into the first NUM_ROWS rows
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: moves video memory, moves the display start if the region
+ *				   is the one on the display
+ */
+void text_home(void)
+{
+	uint32_t region = text_region();
+
+	if(text_top[region] == 0) return;
+	memmove((void *)VIDEO, (void *)(VIDEO + text_top[region] * ROW_BYTES), NUM_ROWS * ROW_BYTES);
+	text_top[region] = 0;
+	if(region == shown_region) show_text(region);
+}
+
+/* 
+ * show_text(uint32_t region)
+ *   DESCRIPTION: Puts a text region on the display, starting from the row
+ *				  at the top of its screen. Nothing is copied. Leaves any
+ *				  scrollback view.
+ *   INPUTS: region - the terminal to show
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: writes the CRTC start address registers
+ */
+void show_text(uint32_t region)
+{
+	shown_region = region;
+	scrollback_live();
+	set_text_start(region * (TEXT_BYTES / 2) + text_top[region] * NUM_COLS);
+}
+
+/* 
+ * set_text_start(uint32_t offset)
+ *   DESCRIPTION: Tells the VGA which character of text memory goes in the
+ *				  top left corner of the display
+ *   INPUTS: offset - characters from 0xB8000
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: writes the CRTC start address registers
+ */
+void set_text_start(uint32_t offset)
+{
+	outb(CRTC_START_HI, CRTC_ADDR);
+	outb((offset >> 8) & 0xFF, CRTC_DATA);
+	outb(CRTC_START_LO, CRTC_ADDR);
+	outb(offset & 0xFF, CRTC_DATA);
 }
@@ -17,6 +17,13 @@ void clear(void);
 extern void test_interrupts(void);
 void set_screen(int x, int y);
 void vert_scroll(void);
+void vert_scroll_lines(int lines);
+uint32_t text_region(void);
+uint8_t * text_base(void);
+uint8_t * text_row(uint32_t region, int y);
+void text_home(void);
+void show_text(uint32_t region);
+void set_text_start(uint32_t offset);
 
 
 void* memset(void* s, int32_t c, uint32_t n);
@@ -38,6 +45,15 @@ extern int screen_y;
 
 extern char err_proc[128];
 
+/* Text memory the screens scroll through, one region per terminal from
+   0xB8000 on. The display shows the active terminal's region. */
+#define TEXT_PAGES 2
+#define TEXT_BYTES (TEXT_PAGES * 4096)
+#define ROW_BYTES 160
+#define TEXT_ROWS (TEXT_BYTES / ROW_BYTES)
+#define TEXT_REGIONS 3
+#define VIEW_REGION TEXT_REGIONS	/* Spare region after them that scrollback is drawn in */
+
 #define ROUND_OFF 0xFFFFE000
 #define SIZEOF_LONG 4
 
@@ -0,0 +1,420 @@
+/*
+* page_cache.c - keeps one copy in memory of each file page that is read or
+*				 mapped, so processes running the same program share its text
+*				 and repeated reads skip the filesystem image, and holds pages
+*				 written to files until they are synced. Pages nothing uses
+*				 stay cached on an LRU list until their slot or frame is needed.
+* @Author: Jack Weil, Charles Zega, Rahul Sharma, Saurav Puri
+* @Date:   2016-12-06 11:30:00
+* @Last Modified by:   Jack
+* @Last Modified time: 2016-12-06 11:30:00
+*/
+
+#include "page_cache.h"
+
+/* File scope variables */
+static cache_page_t cache_pages[PAGE_CACHE_SIZE];
+static cache_page_t * cache_buckets[PAGE_CACHE_BUCKETS];
+
+/* One more than the slot holding each frame, 0 for frames outside the cache */
+static uint16_t frame_slots[NUM_FRAMES];
+
+/* Clean pages with no references, least recently used at the head */
+static cache_page_t * lru_head;
+static cache_page_t * lru_tail;
+
+/* Lookups found in the cache and lookups that had to read the page in */
+static uint32_t cache_hits;
+static uint32_t cache_misses;
+
+/* 
+ * page_cache_hash(uint32_t inode, uint32_t index)
+ *   DESCRIPTION: Picks the hash chain for a page of a file
+ *   INPUTS: inode - the inode of the file
+ *			 index - which 4 KB page of the file
+ *   OUTPUTS: none
+ *   RETURN VALUE: index into cache_buckets
+ *   SIDE EFFECTS: none
+ */
+static uint32_t page_cache_hash(uint32_t inode, uint32_t index)
+{
+	return (inode * PAGE_CACHE_MULT + index) % PAGE_CACHE_BUCKETS;
+}
+
+/* 
+ * page_cache_slot(uint32_t frame)
+ *   DESCRIPTION: Finds the cache slot that holds a frame through
+ *				  frame_slots, called with interrupts off
+ *   INPUTS: frame - physical address of the frame
+ *   OUTPUTS: none
+ *   RETURN VALUE: the slot, NULL if the frame is not in the cache
+ *   SIDE EFFECTS: none
+ */
+static cache_page_t * page_cache_slot(uint32_t frame)
+{
+	if(frame >= FRAME_LIMIT || frame_slots[frame >> FRAME_SHIFT] == 0) return NULL;
+	return &cache_pages[frame_slots[frame >> FRAME_SHIFT] - 1];
+}
+
+/* 
+ * page_cache_unhash(cache_page_t * page)
+ *   DESCRIPTION: Takes a page out of its hash chain so lookups no longer
+ *				  find it, called with interrupts off
+ *   INPUTS: page - the page
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: clears CACHE_HASHED
+ */
+static void page_cache_unhash(cache_page_t * page)
+{
+	cache_page_t ** link;
+
+	if(!(page->flags & CACHE_HASHED)) return;
+	for(link = &cache_buckets[page_cache_hash(page->inode, page->index)]; *link != page; link = &(*link)->next);
+	*link = page->next;
+	page->next = NULL;
+	page->flags &= ~CACHE_HASHED;
+}
+
+/* 
+ * lru_add(cache_page_t * page)
+ *   DESCRIPTION: Puts a page nothing uses at the most recently used end of
+ *				  the LRU list, called with interrupts off
+ *   INPUTS: page - the page
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: sets CACHE_LRU
+ */
+static void lru_add(cache_page_t * page)
+{
+	page->lru_prev = lru_tail;
+	page->lru_next = NULL;
+	if(lru_tail != NULL) lru_tail->lru_next = page;
+	else lru_head = page;
+	lru_tail = page;
+	page->flags |= CACHE_LRU;
+}
+
+/* 
+ * lru_remove(cache_page_t * page)
+ *   DESCRIPTION: Takes a page off the LRU list if it is on it, called with
+ *				  interrupts off
+ *   INPUTS: page - the page
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: clears CACHE_LRU
+ */
+static void lru_remove(cache_page_t * page)
+{
+	if(!(page->flags & CACHE_LRU)) return;
+	if(page->lru_prev != NULL) page->lru_prev->lru_next = page->lru_next;
+	else lru_head = page->lru_next;
+	if(page->lru_next != NULL) page->lru_next->lru_prev = page->lru_prev;
+	else lru_tail = page->lru_prev;
+	page->lru_prev = NULL;
+	page->lru_next = NULL;
+	page->flags &= ~CACHE_LRU;
+}
+
+/* 
+ * page_cache_free(cache_page_t * page)
+ *   DESCRIPTION: Gives an unmapped page's frame back and frees its slot,
+ *				  called with interrupts off
+ *   INPUTS: page - the page
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: frees the frame
+ */
+static void page_cache_free(cache_page_t * page)
+{
+	lru_remove(page);
+	page_cache_unhash(page);
+	frame_slots[page->frame >> FRAME_SHIFT] = 0;
+	free_frame(page->frame);
+	page->frame = 0;
+	page->flags = 0;
+}
+
+/* 
+ * page_cache_get(uint32_t inode, uint32_t index)
+ *   DESCRIPTION: Gets the frame holding a page of a file, reading it from
+ *				  the filesystem the first time, and takes a reference on it.
+ *				  The least recently used idle page makes room when the
+ *				  slots or frames run out.
+ *   INPUTS: inode - the inode of the file
+ *			 index - which 4 KB page of the file
+ *   OUTPUTS: none
+ *   RETURN VALUE: physical address of the frame, 0 if out of frames or slots
+ *   SIDE EFFECTS: may take a frame from the frame allocator, may evict a page
+ */
+uint32_t page_cache_get(uint32_t inode, uint32_t index)
+{
+	int i;
+	uint32_t flags, offset, length, size;
+	uint32_t bucket = page_cache_hash(inode, index);
+	cache_page_t * page;
+
+	cli_and_save(flags);
+
+	/* Already in memory, just take another reference */
+	for(page = cache_buckets[bucket]; page != NULL; page = page->next){
+		if(page->inode == inode && page->index == index){
+			if(page->refs++ == 0) lru_remove(page);
+			cache_hits++;
+			restore_flags(flags);
+			return page->frame;
+		}
+	}
+
+	/* Find a free slot, or free the least recently used one */
+	for(i = 0; i < PAGE_CACHE_SIZE; i++){
+		if(cache_pages[i].frame == 0) break;
+	}
+	if(i == PAGE_CACHE_SIZE){
+		if(lru_head == NULL){
+			restore_flags(flags);
+			return 0;
+		}
+		page = lru_head;
+		page_cache_free(page);
+	}
+	else{
+		page = &cache_pages[i];
+	}
+
+	/* Then a frame, idle pages give theirs up first */
+	page->frame = alloc_frame();
+	while(page->frame == 0 && lru_head != NULL){
+		page_cache_free(lru_head);
+		page->frame = alloc_frame();
+	}
+	if(page->frame == 0){
+		restore_flags(flags);
+		return 0;
+	}
+	cache_misses++;
+
+	/* Copy the page in through the kernel's map of free RAM, past the end of the file is zero */
+	memset((void *)page->frame, 0, FRAME_SIZE);
+	offset = index * FRAME_SIZE;
+	size = read_size(inode);
+	if(offset < size){
+		length = size - offset;
+		if(length > FRAME_SIZE) length = FRAME_SIZE;
+		memcpy((void *)page->frame, (void *)file_block(inode, index), length);
+	}
+
+	frame_slots[page->frame >> FRAME_SHIFT] = page - cache_pages + 1;
+	page->inode = inode;
+	page->index = index;
+	page->refs = 1;
+	page->flags = CACHE_HASHED;
+	page->next = cache_buckets[bucket];
+	cache_buckets[bucket] = page;
+
+	restore_flags(flags);
+	return page->frame;
+}
+
+/* 
+ * page_cache_readahead(uint32_t inode, uint32_t first, uint32_t count)
+ *   DESCRIPTION: Reads pages of a file into the cache before they are asked
+ *				  for, they wait on the LRU list like any idle page
+ *   INPUTS: inode - the inode of the file
+ *			 first - the first 4 KB page to read
+ *			 count - the number of pages, stops early at the end of the file
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: may take frames from the frame allocator, may evict pages
+ */
+void page_cache_readahead(uint32_t inode, uint32_t first, uint32_t count)
+{
+	uint32_t index, frame, pages = (read_size(inode) + FRAME_SIZE - 1) / FRAME_SIZE;
+
+	for(index = first; index < first + count && index < pages; index++){
+		if(page_cache_find(inode, index) != 0) continue;
+		frame = page_cache_get(inode, index);
+		if(frame == 0) return;
+		page_cache_put(frame);
+	}
+}
+
+/* 
+ * page_cache_dup(uint32_t frame)
+ *   DESCRIPTION: Takes another reference on a frame from page_cache_get,
+ *				  used when a mapping of it is copied
+ *   INPUTS: frame - physical address of the frame
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: none
+ */
+void page_cache_dup(uint32_t frame)
+{
+	uint32_t flags;
+	cache_page_t * page;
+
+	cli_and_save(flags);
+	page = page_cache_slot(frame);
+	if(page != NULL && page->refs++ == 0) lru_remove(page);
+	restore_flags(flags);
+}
+
+/* 
+ * page_cache_put(uint32_t frame)
+ *   DESCRIPTION: Drops a reference on a frame from page_cache_get, when
+ *				  nothing uses it anymore a clean page goes on the LRU list
+ *				  and a page its file dropped goes back to the allocator
+ *   INPUTS: frame - physical address of the frame
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: may free the frame
+ */
+void page_cache_put(uint32_t frame)
+{
+	uint32_t flags;
+	cache_page_t * page;
+
+	cli_and_save(flags);
+	page = page_cache_slot(frame);
+	if(page != NULL && --page->refs == 0){
+		if(!(page->flags & CACHE_HASHED)) page_cache_free(page);
+		else if(!(page->flags & CACHE_DIRTY)) lru_add(page);
+	}
+	restore_flags(flags);
+}
+
+/* 
+ * page_cache_find(uint32_t inode, uint32_t index)
+ *   DESCRIPTION: Looks for a page of a file in the cache without reading it
+ *				  in, so reads see data that has not been synced yet
+ *   INPUTS: inode - the inode of the file
+ *			 index - which 4 KB page of the file
+ *   OUTPUTS: none
+ *   RETURN VALUE: physical address of the frame, 0 if the page is not cached
+ *   SIDE EFFECTS: none, no reference is taken
+ */
+uint32_t page_cache_find(uint32_t inode, uint32_t index)
+{
+	uint32_t flags, frame = 0;
+	cache_page_t * page;
+
+	cli_and_save(flags);
+	for(page = cache_buckets[page_cache_hash(inode, index)]; page != NULL; page = page->next){
+		if(page->inode == inode && page->index == index){
+			frame = page->frame;
+			break;
+		}
+	}
+	restore_flags(flags);
+	return frame;
+}
+
+/* 
+ * page_cache_dirty(uint32_t frame)
+ *   DESCRIPTION: Marks a frame from page_cache_get as written, it stays in
+ *				  the cache until page_cache_sync copies it back
+ *   INPUTS: frame - physical address of the frame
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: none
+ */
+void page_cache_dirty(uint32_t frame)
+{
+	uint32_t flags;
+	cache_page_t * page;
+
+	cli_and_save(flags);
+	page = page_cache_slot(frame);
+	if(page != NULL){
+		lru_remove(page);
+		page->flags |= CACHE_DIRTY;
+	}
+	restore_flags(flags);
+}
+
+/* 
+ * page_cache_invalidate(uint32_t inode, uint32_t first)
+ *   DESCRIPTION: Drops the pages of a file from first on after it is cut
+ *				  short, they are not written back. Pages that are still
+ *				  mapped leave the hash chains and are freed on the last put.
+ *   INPUTS: inode - the inode of the file
+ *			 first - the first 4 KB page that is gone
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: may free frames
+ */
+void page_cache_invalidate(uint32_t inode, uint32_t first)
+{
+	int i;
+	uint32_t flags;
+	cache_page_t * page;
+
+	cli_and_save(flags);
+	for(i = 0; i < PAGE_CACHE_SIZE; i++){
+		page = &cache_pages[i];
+		if(page->frame == 0 || !(page->flags & CACHE_HASHED)) continue;
+		if(page->inode != inode || page->index < first) continue;
+
+		page->flags &= ~CACHE_DIRTY;
+		if(page->refs == 0) page_cache_free(page);
+		else page_cache_unhash(page);
+	}
+	restore_flags(flags);
+}
+
+/* 
+ * page_cache_sync(void)
+ *   DESCRIPTION: Copies every dirty page back to its data block in the
+ *				  filesystem image, pages nothing maps go on the LRU list
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: the number of pages written back
+ *   SIDE EFFECTS: writes the filesystem image
+ */
+int32_t page_cache_sync(void)
+{
+	int i;
+	int32_t count = 0;
+	uint32_t flags, block;
+	cache_page_t * page;
+
+	cli_and_save(flags);
+	for(i = 0; i < PAGE_CACHE_SIZE; i++){
+		page = &cache_pages[i];
+		if(page->frame == 0 || !(page->flags & CACHE_DIRTY)) continue;
+
+		block = file_block(page->inode, page->index);
+		if(block != 0){
+			memcpy((void *)block, (void *)page->frame, BLOCK_SIZE);
+			count++;
+		}
+		page->flags &= ~CACHE_DIRTY;
+		if(page->refs == 0) lru_add(page);
+	}
+	restore_flags(flags);
+	return count;
+}
+
+/* 
+ * page_cache_stats(uint32_t * stats)
+ *   DESCRIPTION: Reports how well the cache is doing
+ *   INPUTS: stats - gets CACHE_STAT_WORDS words, the hits, the misses and
+ *					 the number of pages in memory
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: none
+ */
+void page_cache_stats(uint32_t * stats)
+{
+	int i;
+	uint32_t flags, pages = 0;
+
+	cli_and_save(flags);
+	for(i = 0; i < PAGE_CACHE_SIZE; i++){
+		if(cache_pages[i].frame != 0) pages++;
+	}
+	stats[0] = cache_hits;
+	stats[1] = cache_misses;
+	stats[2] = pages;
+	restore_flags(flags);
+}
@@ -0,0 +1,57 @@
+/*
+* page_cache.h - header file for page_cache.c
+* @Author: Jack Weil, Charles Zega, Rahul Sharma, Saurav Puri
+* @Date:   2016-12-06 11:30:00
+* @Last Modified by:   Jack
+* @Last Modified time: 2016-12-06 11:30:00
+*/
+
+#ifndef _PAGE_CACHE_H
+#define _PAGE_CACHE_H
+
+#include "types.h"
+#include "lib.h"
+#include "frame_alloc.h"
+#include "file_sys.h"
+
+#define PAGE_CACHE_SIZE 1024		/* Most file pages held at once, enough to map a whole file */
+#define PAGE_CACHE_BUCKETS 64		/* Hash chains, keyed by inode and page index */
+#define PAGE_CACHE_MULT 31			/* Odd multiplier that spreads inodes across the chains */
+#define CACHE_DIRTY 0x1				/* Written since it was read or last synced */
+#define CACHE_HASHED 0x2			/* Still in a hash chain, cleared once the file drops the page */
+#define CACHE_LRU 0x4				/* Idle and clean, on the LRU list */
+#define CACHE_STAT_WORDS 3			/* Hits, misses and pages held, as page_cache_stats reports them */
+
+/*
+ * One page of a file held in a frame
+ * inode -- the inode of the file
+ * index -- which 4 KB page of the file this is
+ * frame -- physical address of the frame, 0 if the slot is free
+ * refs -- the number of mappings of the frame
+ * flags -- CACHE_DIRTY, CACHE_HASHED and CACHE_LRU
+ * next -- the next page in the same hash chain
+ * lru_prev, lru_next -- neighbours on the LRU list
+ */
+typedef struct cache_page cache_page_t;
+struct cache_page {
+	uint32_t inode;
+	uint32_t index;
+	uint32_t frame;
+	uint32_t refs;
+	uint32_t flags;
+	cache_page_t * next;
+	cache_page_t * lru_prev;
+	cache_page_t * lru_next;
+};
+
+uint32_t page_cache_get(uint32_t inode, uint32_t index);
+void page_cache_dup(uint32_t frame);
+void page_cache_put(uint32_t frame);
+uint32_t page_cache_find(uint32_t inode, uint32_t index);
+void page_cache_dirty(uint32_t frame);
+void page_cache_invalidate(uint32_t inode, uint32_t first);
+int32_t page_cache_sync(void);
+void page_cache_stats(uint32_t * stats);
+void page_cache_readahead(uint32_t inode, uint32_t first, uint32_t count);
+
+#endif /* _PAGE_CACHE_H */
@@ -9,14 +9,16 @@
 #include "paging.h"
 
 /* File scope variables */
-uint32_t page_directory[MAX_PROCESSES][P_SIZE] __attribute__((aligned(FOUR_KB)));
-uint32_t page_table[2 * MAX_PROCESSES - 1][P_SIZE] __attribute__((aligned(FOUR_KB)));
+uint32_t * page_directory[MAX_PROCESSES];
+static uint32_t kernel_page_directory[P_SIZE] __attribute__((aligned(FOUR_KB)));
+static uint32_t kernel_page_table[P_SIZE] __attribute__((aligned(FOUR_KB)));
 
 /* 
  * init_paging
- *   DESCRIPTION: Initialize paging by declaring the page directory and table
- * 				  with all entries not present, map the kernel code and video
- *				  memory, then enable paging with the registers CR0,CR3,CR4
+ *   DESCRIPTION: Initialize paging by building the kernel page directory and
+ *				  the table for the first 4MB with all entries not present, map
+ *				  the kernel code, video memory and the frame allocator's memory,
+ *				  then enable paging with the registers CR0,CR3,CR4
  *   INPUTS: none
  *   OUTPUTS: none
  *   RETURN VALUE: none
@@ -26,46 +28,54 @@ void init_paging(void)
 {
 	/* Loop through the page directory and table setting all entries to
 	 * not present by marking the LSB 0 (in this case all bits 0) */
-	int i, j, buf_ptr;
+	int i, buf_ptr;
 	for(i = 0; i < P_SIZE; i++){
-		for(j = 0; j < MAX_PROCESSES; j++){
-			page_directory[j][i] = DEFAULT_PDE;
-		}
-		for(j = 0; j < MAX_PROCESSES * 2 - 1; j++){
-			page_table[j][i] = (i * FOUR_KB) | TABLE_PDE;	
-		}
+		kernel_page_directory[i] = DEFAULT_PDE;
+		kernel_page_table[i] = (i * FOUR_KB) | TABLE_PDE;
 	}
+	page_directory[0] = kernel_page_directory;
 
 	/* Mapping the page table to first page directory entry and set present */
-	for(j = 0; j < MAX_PROCESSES; j++){
-		page_directory[j][0] = ((uint32_t) page_table[j]) | VMEM_PDE;
-		page_table[j][VMEM_OFFSET >> P_SHIFT] |= 1;
+	kernel_page_directory[0] = ((uint32_t) kernel_page_table) | VMEM_PDE;
+	for(i = 0; i < TEXT_PAGES; i++){
+		kernel_page_table[(VMEM_OFFSET >> P_SHIFT) + i] |= 1;
 	}
 
 	/* Mapping kernel memory to the second page directory entry */
-	page_directory[0][1] = KERNEL_PDE;
-
-	/* Set the video memory page frame to present (LSB), the 1,2,3 offsets
-	   are for the three copies of video memory mappings (one per terminal) */
-	page_table[0][(VMEM_OFFSET >> P_SHIFT) + 1] |= 1;
-	page_table[0][(VMEM_OFFSET >> P_SHIFT) + 2] |= 1;
-	page_table[0][(VMEM_OFFSET >> P_SHIFT) + 3] |= 1;
-	for(i = 0; i < 3; i++){
-		buf_ptr = VMEM_OFFSET + (i+1) * FOUR_KB;
+	kernel_page_directory[1] = KERNEL_PDE;
+
+	/* Map the frames the allocator hands out at their physical addresses so
+	   the kernel can fill in page tables and user frames from any process */
+	for(i = IDENT_PDE_START; i < IDENT_PDE_END; i++){
+		kernel_page_directory[i] = (i << D_SHIFT) | KERNEL_PDE_FLAGS;
+	}
+
+	/* Set the text regions of terminals 1 and 2 to present. They are the
+	   same in every process so they are global, the pages at VMEM_OFFSET
+	   are not since map_text points them at the region of each process's
+	   terminal. The new regions start out as a copy of the boot screen.
+	   The scrollback view region after them is mapped the same way. */
+	for(i = TEXT_PAGES; i < TEXT_PAGES * (VIEW_REGION + 1); i++){
+		kernel_page_table[(VMEM_OFFSET >> P_SHIFT) + i] |= 1 | PTE_GLOBAL;
+	}
+	for(i = 1; i < TEXT_REGIONS; i++){
+		buf_ptr = VMEM_OFFSET + i * TEXT_BYTES;
 		memcpy((void *)buf_ptr, (void *) VMEM_OFFSET, 2*NUM_COLS*NUM_ROWS);
 	} 
 
 	/* Initialize the control registers for paging. CR3 gets the address
-	 * of the page directory table. CR4 bit 4 gets set for 4MB pages.
-	 * CR0 bit 31 gets set to enable paging. */
+	 * of the page directory table. CR4 bit 4 gets set for 4MB pages and
+	 * bit 7 so the global kernel pages survive CR3 reloads.
+	 * CR0 bit 31 gets set to enable paging, bit 16 makes read-only
+	 * user pages read-only for the kernel too. */
 	__asm__ volatile("\n\t"
 				 "init_paging_asm:\n\t"
 				 "movl %%eax, %%cr3\n\t"
 				 "movl %%cr4, %%eax\n\t"
-				 "orl  $0x00000010, %%eax\n\t"
+				 "orl  $0x00000090, %%eax\n\t"
 				 "movl %%eax, %%cr4\n\t"
 				 "movl %%cr0, %%eax\n\t"
-				 "orl  $0x80000000, %%eax\n\t"
+				 "orl  $0x80010000, %%eax\n\t"
 				 "movl %%eax, %%cr0\n\t"
 			:
 			: "a"(page_directory[0]) 
@@ -75,36 +85,144 @@ void init_paging(void)
 }
 
 /* 
- * void map_page(void * p_addr, void * v_addr, uint32_t flags)
+ * int32_t new_page_directory(int pd)
+ *   DESCRIPTION: Allocates a page directory for a process that shares the
+ *				  kernel mappings, with a private copy of the first 4MB table
+ *				  so its video memory mapping can follow its terminal
+ *   INPUTS: int pd -- index in page directories for the new process
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 if out of frames, 0 on success
+ *   SIDE EFFECTS: Takes two frames from the frame allocator
+ */
+int32_t new_page_directory(int pd)
+{
+	uint32_t * dir = (uint32_t *)alloc_frame();
+	uint32_t * table = (uint32_t *)alloc_frame();
+
+	if(dir == NULL || table == NULL){
+		if(dir != NULL) free_frame((uint32_t)dir);
+		if(table != NULL) free_frame((uint32_t)table);
+		return -1;
+	}
+
+	/* Start from the kernel's view of memory and nothing in user space */
+	memcpy(dir, kernel_page_directory, FOUR_KB);
+	memcpy(table, kernel_page_table, FOUR_KB);
+	dir[0] = ((uint32_t) table) | VMEM_PDE;
+
+	page_directory[pd] = dir;
+	return 0;
+}
+
+/* 
+ * void free_page_directory(int pd)
+ *   DESCRIPTION: Gives back the page directory of a process along with its
+ *				  first 4MB table, its user pages and its user page tables.
+ *				  Video memory mapped by vidmap sits below FRAME_BASE, so
+ *				  the frame allocator ignores it.
+ *   INPUTS: int pd -- index in page directories of a process that has halted
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: The directory must not be in CR3 when this is called
+ */
+void free_page_directory(int pd)
+{
+	int i, j;
+	uint32_t * dir = page_directory[pd];
+	uint32_t * table;
+
+	if(pd == 0 || dir == NULL) return;
+
+	/* Only the user half of the directory belongs to the process */
+	for(i = V_PAGE >> D_SHIFT; i < P_SIZE; i++){
+		if(!(dir[i] & 0x1)) continue;
+		if(dir[i] & EXT_BIT){
+			free_frames(dir[i] & PDE_ADDR_4MB, FRAMES_PER_4MB);
+			continue;
+		}
+
+		/* Free the pages that were touched, then the table */
+		table = (uint32_t *)(dir[i] & (~LSB_12));
+		for(j = 0; j < P_SIZE; j++){
+			if(!(table[j] & 0x1)) continue;
+			if(table[j] & PTE_SHARED) page_cache_put(table[j] & (~LSB_12));
+			else free_frame(table[j] & (~LSB_12));
+		}
+		free_frame((uint32_t)table);
+	}
+
+	free_frame(dir[0] & (~LSB_12));
+	free_frame((uint32_t)dir);
+	page_directory[pd] = NULL;
+}
+
+/* 
+ * int32_t map_page(int pd, void * p_addr, void * v_addr, uint32_t flags)
  *   DESCRIPTION: Maps a virtual address to a physical address in the correct
- *				  page table and marks it as present
- *   INPUTS: void * p_addr -- a physical address
+ *				  page table and marks it as present, allocating the page
+ *				  table if the directory does not have one yet
+ *   INPUTS: int pd -- index in page directories
+ *			 void * p_addr -- a physical address
  *			 void * v_addr -- the virtal address to map it
  *           uint32_t flags -- the information to set in the page table
  *							   about this address
  *   OUTPUTS: none
- *   RETURN VALUE: none
+ *   RETURN VALUE: -1 if a page table could not be allocated, 0 on success
  *   SIDE EFFECTS: Changes value of entries in a page table, flushes the TLBs
  */
-void map_page(int pd, void * p_addr, void * v_addr, uint32_t flags)
+int32_t map_page(int pd, void * p_addr, void * v_addr, uint32_t flags)
 {
-	int user = 0;
-	if((uint32_t)v_addr > FOUR_MB) user = MAX_PROCESSES - 1;
+	int i;
+	uint32_t * table;
+
 	/* Get the index in the page directory and table from the virtual address */
 	uint32_t pd_index = (uint32_t) v_addr >> D_SHIFT;
 	uint32_t pt_index = ((uint32_t) v_addr) >> P_SHIFT & LSB_10;
 
 	/* If the page is extended just return */
-	if(page_directory[pd][pd_index] & EXT_BIT) return;
+	if(page_directory[pd][pd_index] & EXT_BIT) return 0;
 
-	/* Mark it present and user privilege and map to page table */
-	page_directory[pd][pd_index] |= (USER_BIT | ((uint32_t)page_table[pd + user] & (~LSB_12)));
+	/* Give the directory an empty page table for this 4MB if it has none */
+	if(!(page_directory[pd][pd_index] & 0x1)){
+		table = (uint32_t *)alloc_frame();
+		if(table == NULL) return -1;
+		for(i = 0; i < P_SIZE; i++){
+			table[i] = 0;
+		}
+		page_directory[pd][pd_index] = (uint32_t)table | TABLE_PDE;
+	}
+	table = (uint32_t *)(page_directory[pd][pd_index] & (~LSB_12));
+
+	/* Mark it present and user privilege */
+	page_directory[pd][pd_index] |= USER_BIT;
 
 	/* Mark the page present and add its PTE */
-    page_table[pd + user][pt_index] = ((uint32_t)p_addr) | (flags & LSB_12) | 0x1; 
+    table[pt_index] = ((uint32_t)p_addr) | (flags & LSB_12) | 0x1; 
 
-    /* Flush the TLB */
-    flush_tlb();
+    /* Only this page's translation can be stale */
+    flush_tlb_page(v_addr);
+    return 0;
+}
+
+/* 
+ * void map_text(int pd, int term)
+ *   DESCRIPTION: Points the video memory pages of a process at the text
+ *				  region of its terminal. The mapping never changes after,
+ *				  switching terminals only moves the display.
+ *   INPUTS: int pd -- index in page directories
+ *			 int term -- the terminal the process runs in
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Changes PTEs in the first page table of the process
+ */
+void map_text(int pd, int term)
+{
+	int i;
+	uint32_t base = VMEM_OFFSET + term * TEXT_BYTES;
+
+	for(i = 0; i < TEXT_PAGES; i++){
+		map_page(pd, (void *)(base + i * FOUR_KB), (void *)(VMEM_OFFSET + i * FOUR_KB), VMEM_PDE);
+	}
 }
 
 /* 
@@ -127,8 +245,8 @@ void ext_map_page(int pd, void * p_addr, void * v_addr, uint32_t flags)
 	/* Mark the page present and add its PTE */
 	page_directory[pd][pd_index] = ((uint32_t)p_addr) | (flags & LSB_12) | 0x1;
 
-    /* Flush the TLB */
-    flush_tlb();
+    /* One invlpg drops the whole 4MB translation */
+    flush_tlb_page(v_addr);
 }
 
 /* 
@@ -150,8 +268,8 @@ void ext_unmap_page(int pd, void * v_addr)
 
 	page_directory[pd][pd_index] &= (~1);
 
-    /* Flush the TLB */
-    flush_tlb();
+    /* One invlpg drops the whole 4MB translation */
+    flush_tlb_page(v_addr);
 }
 
 /* 
@@ -175,17 +293,220 @@ void unmap_page(int pd)
     flush_tlb();
 }
 
+/* 
+ * uint32_t * get_pte(int pd, void * v_addr)
+ *   DESCRIPTION: Finds the page table entry for a virtual address
+ *   INPUTS: int pd -- index in page directories
+ *			 void * v_addr -- the virtual address to look up
+ *   OUTPUTS: none
+ *   RETURN VALUE: pointer to the PTE, NULL if the address has no page table
+ *   SIDE EFFECTS: none
+ */
+uint32_t * get_pte(int pd, void * v_addr)
+{
+	uint32_t pde = page_directory[pd][(uint32_t) v_addr >> D_SHIFT];
+
+	/* 4MB pages and missing tables have no PTE */
+	if(!(pde & 0x1) || (pde & EXT_BIT)) return NULL;
+
+	return ((uint32_t *)(pde & (~LSB_12))) + (((uint32_t) v_addr >> P_SHIFT) & LSB_10);
+}
+
+/* 
+ * int32_t fill_page(pcb_t * pcb, void * v_addr)
+ *   DESCRIPTION: Gives a user page its frame the first time it is touched.
+ *				  Text pages are mapped read-only from the page cache so every
+ *				  process running the program shares them. Other pages get a
+ *				  private frame holding the part of the program image (loaded
+ *				  flat at V_ADDR) that covers them, the rest zeroed.
+ *   INPUTS: pcb_t * pcb -- the faulting process
+ *			 void * v_addr -- the address that faulted
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 if out of frames, 0 on success
+ *   SIDE EFFECTS: Takes a frame from the frame allocator or the page cache and maps it
+ */
+int32_t fill_page(pcb_t * pcb, void * v_addr)
+{
+	uint32_t page = (uint32_t) v_addr & (~LSB_12);
+	uint32_t frame, offset, length;
+
+	/* Shared text */
+	if(page >= V_ADDR && page < pcb->exe_ro_end){
+		frame = page_cache_get(pcb->exe_inode, (page - V_ADDR) >> P_SHIFT);
+		if(frame == 0) return -1;
+		if(-1 == map_page(pcb->task_id, (void *)frame, (void *)page, USER_RO_PTE_FLAGS | PTE_SHARED)){
+			page_cache_put(frame);
+			return -1;
+		}
+		return 0;
+	}
+
+	frame = alloc_frame();
+	if(frame == 0) return -1;
+
+	/* Fill the frame through the kernel's map of free RAM */
+	memset((void *)frame, 0, FOUR_KB);
+	if(page >= V_ADDR && page < V_ADDR + pcb->exe_size){
+		offset = page - V_ADDR;
+		length = pcb->exe_size - offset;
+		if(length > FOUR_KB) length = FOUR_KB;
+		read_data(pcb->exe_inode, offset, (uint8_t *)frame, length);
+	}
+
+	if(-1 == map_page(pcb->task_id, (void *)frame, (void *)page, USER_PTE_FLAGS)){
+		free_frame(frame);
+		return -1;
+	}
+	return 0;
+}
+
+/* 
+ * int32_t copy_page_directory(int new_pd, int old_pd)
+ *   DESCRIPTION: Gives a new process the same user memory as an old one.
+ *				  Private pages become read-only copy-on-write in both, page
+ *				  cache and video pages are mapped as they are.
+ *   INPUTS: int new_pd -- index in page directories of the copy, from new_page_directory
+ *			 int old_pd -- index in page directories of the process being copied
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 if out of frames for page tables, 0 on success
+ *   SIDE EFFECTS: Changes PTEs of the old process, which must be the current one
+ */
+int32_t copy_page_directory(int new_pd, int old_pd)
+{
+	int i, j;
+	uint32_t * table;
+	uint32_t frame;
+	void * v_addr;
+
+	/* The video mapping follows the terminal, not the kernel template */
+	for(i = 0; i < TEXT_PAGES; i++){
+		get_pte(new_pd, (void *)VMEM_OFFSET)[i] = get_pte(old_pd, (void *)VMEM_OFFSET)[i];
+	}
+
+	for(i = V_PAGE >> D_SHIFT; i < P_SIZE; i++){
+		if(!(page_directory[old_pd][i] & 0x1) || (page_directory[old_pd][i] & EXT_BIT)) continue;
+		table = (uint32_t *)(page_directory[old_pd][i] & (~LSB_12));
+		for(j = 0; j < P_SIZE; j++){
+			if(!(table[j] & 0x1)) continue;
+			frame = table[j] & (~LSB_12);
+			v_addr = (void *)((i << D_SHIFT) | (j << P_SHIFT));
+
+			/* Private pages from the allocator are shared until one side writes */
+			if(!(table[j] & PTE_SHARED) && frame >= FRAME_BASE){
+				table[j] = (table[j] & (~PTE_RW)) | PTE_COW;
+			}
+			if(-1 == map_page(new_pd, (void *)frame, v_addr, table[j])) return -1;
+			if(table[j] & PTE_SHARED) page_cache_dup(frame);
+			else if(table[j] & PTE_COW) share_frame(frame);
+		}
+	}
+
+	/* map_page already dropped each changed address from the TLB */
+	return 0;
+}
+
+/* 
+ * int32_t cow_page(int pd, void * v_addr)
+ *   DESCRIPTION: Handles a write to a copy-on-write page. The last process
+ *				  mapping the frame just gets it back writable, the others get
+ *				  a private copy of it.
+ *   INPUTS: int pd -- index in page directories of the faulting process
+ *			 void * v_addr -- the address that faulted
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 if the page is not copy-on-write or out of frames, 0 on success
+ *   SIDE EFFECTS: Changes the PTE, flushes the TLBs
+ */
+int32_t cow_page(int pd, void * v_addr)
+{
+	uint32_t * pte = get_pte(pd, v_addr);
+	uint32_t frame, copy;
+
+	if(pte == NULL || !(*pte & 0x1) || !(*pte & PTE_COW)) return -1;
+	frame = *pte & (~LSB_12);
+
+	if(frame_sharers(frame) == 0){
+		*pte = (*pte | PTE_RW) & (~PTE_COW);
+	}
+	else{
+		copy = alloc_frame();
+		if(copy == 0) return -1;
+		memcpy((void *)copy, (void *)frame, FOUR_KB);
+		free_frame(frame);
+		*pte = copy | (((*pte & LSB_12) | PTE_RW) & (~PTE_COW));
+	}
+
+	flush_tlb_page(v_addr);
+	return 0;
+}
+
+/* 
+ * uint32_t find_user_range(int pd, uint32_t start, uint32_t end, uint32_t pages)
+ *   DESCRIPTION: Finds the lowest run of unmapped pages in part of a user
+ *				  address space
+ *   INPUTS: int pd -- index in page directories
+ *			 uint32_t start -- first address to look at, page aligned
+ *			 uint32_t end -- one past the last address to look at
+ *			 uint32_t pages -- the number of pages wanted
+ *   OUTPUTS: none
+ *   RETURN VALUE: the first address of the run, 0 if there is none
+ *   SIDE EFFECTS: none
+ */
+uint32_t find_user_range(int pd, uint32_t start, uint32_t end, uint32_t pages)
+{
+	uint32_t addr, run = 0;
+	uint32_t * pte;
+
+	for(addr = start; addr < end && run < pages; addr += FOUR_KB){
+		pte = get_pte(pd, (void *)addr);
+		if(pte != NULL && (*pte & 0x1)) run = 0;
+		else run++;
+	}
+
+	if(run < pages) return 0;
+	return addr - pages * FOUR_KB;
+}
+
+/* 
+ * void unmap_user_page(int pd, void * v_addr)
+ *   DESCRIPTION: Takes one page out of a user address space and drops the
+ *				  frame behind it
+ *   INPUTS: int pd -- index in page directories
+ *			 void * v_addr -- an address in the page
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Changes the PTE, flushes its TLB entry
+ */
+void unmap_user_page(int pd, void * v_addr)
+{
+	uint32_t * pte = get_pte(pd, v_addr);
+
+	if(pte == NULL || !(*pte & 0x1)) return;
+
+	if(*pte & PTE_SHARED) page_cache_put(*pte & (~LSB_12));
+	else free_frame(*pte & (~LSB_12));
+	*pte = 0;
+
+	flush_tlb_page(v_addr);
+}
+
 /* 
  * void set_page_directory(uint32_t pd)
- *   DESCRIPTION: Changes the value in the PDBR
+ *   DESCRIPTION: Changes the value in the PDBR, unless it already holds
+ *				  this page directory
  *   INPUTS: uint32_t pd - index in page directories
  *   OUTPUTS: none
  *   RETURN VALUE: none
- *   SIDE EFFECTS: Flushes the TLB
+ *   SIDE EFFECTS: Flushes the non-global TLB entries when the PDBR changes
  */
 void set_page_directory(uint32_t pd)
 {
-	/* Flush the TLB by refreshing CR3 register */
+	uint32_t cr3;
+
+	/* Switching to the same address space would only throw away the TLB */
+	__asm__ volatile("movl %%cr3, %0" : "=r"(cr3));
+	if(cr3 == (uint32_t)page_directory[pd]) return;
+
+	/* Load the new page directory */
 	__asm__ volatile("\n\t"
 				 "set_pd:\n\t"
 				 "movl %%eax, %%cr3\n\t"
@@ -195,9 +516,28 @@ void set_page_directory(uint32_t pd)
 			);
 }
 
+/* 
+ * void flush_tlb_page(void * v_addr)
+ *   DESCRIPTION: Drops the TLB entry for one page, called when a single
+ *				  entry of the paging structures changes
+ *   INPUTS: void * v_addr -- an address in the page that changed
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Flushes one TLB entry, global or not
+ */
+void flush_tlb_page(void * v_addr)
+{
+	__asm__ volatile("invlpg (%0)"
+			:
+			: "r"(v_addr)
+			: "memory"
+			);
+}
+
 /* 
  * void flush_tlb(void)
- *   DESCRIPTION: Refreshes all the values in the TLBs, called upon a change in paging
+ *   DESCRIPTION: Refreshes all the non-global values in the TLBs, called
+ *				  upon a change to many entries in paging
  *   INPUTS: none
  *   OUTPUTS: none
  *   RETURN VALUE: none
@@ -218,43 +558,20 @@ void flush_tlb(void)
 
 /* 
  * void switch_vidmem(vuint32_t old, uint32_t new)
- *   DESCRIPTION: Switches between two video memory mappings for terminals
+ *   DESCRIPTION: Switches the display from one terminal's text region to
+ *				  another's. Every process keeps its own terminal's region
+ *				  mapped, so no PTE changes and nothing is copied, the cost
+ *				  is the same whatever the screens hold.
  *   INPUTS: old - the terminal being switched from
  *			 new - the terminal being switched to
  *   OUTPUTS: none
  *   RETURN VALUE: none
- *   SIDE EFFECTS: Changes mappings in the paging structures
+ *   SIDE EFFECTS: Moves the VGA display start
  */
 void switch_vidmem(uint32_t old, uint32_t new){
-	int pd;
-	pcb_t * pcb;
-
 	/* Do nothing if switching to curr terminal */
 	if(old == new) return;
 
-	/* Loop through the active processes  */
-	for(pd = 1; pd < MAX_PROCESSES; pd++){
-		if((tasks_bitmap & (0x1 << pd))) continue;
-		pcb = (pcb_t *)(EIGHT_MB - (pd * EIGHT_KB));
-
-		/* Set the video mapping to point to the buffer for its terminal */
-		if(pcb->term == old){
-			page_table[pd][VMEM_OFFSET >> P_SHIFT] \
-				= (page_table[pd][VMEM_OFFSET >> P_SHIFT] & LSB_12) \
-				| (VMEM_OFFSET + FOUR_KB * (old + 1));
-			page_table[pd + USER_OFFSET][0] = (page_table[pd + USER_OFFSET][0] & LSB_12) | (VMEM_OFFSET + FOUR_KB * (old + 1));
-		}
-		/* Set the video mapping to point to the actual video memory */
-		else if(pcb->term == new){
-			page_table[pd][VMEM_OFFSET >> P_SHIFT] = (page_table[pd][VMEM_OFFSET >> P_SHIFT] & LSB_12) | VMEM_OFFSET;
-			page_table[pd + USER_OFFSET][0] = (page_table[pd + USER_OFFSET][0] & LSB_12) | VMEM_OFFSET;
-		}
-	}
-
-	/* Switch to kernel addr space, swap the vmem buffers, and return to curr process addr space */
-	set_page_directory(0);
-	memcpy((void *)(VMEM_OFFSET + (old + 1) * FOUR_KB), (void *) VMEM_OFFSET, 2*NUM_ROWS*NUM_COLS);
-	memcpy((void *)VMEM_OFFSET, (void *) (VMEM_OFFSET + (new + 1) * FOUR_KB), 2*NUM_ROWS*NUM_COLS);
-	set_page_directory(get_pcb()->task_id);
+	show_text(new);
 }
 
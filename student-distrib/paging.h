@@ -13,6 +13,8 @@
 #include "lib.h"
 #include "asm_handler.h"
 #include "syscall.h"
+#include "frame_alloc.h"
+#include "page_cache.h"
 
 #define P_SIZE 1024				/* The number of page directory entries and page table entries */
 #define P_SHIFT 12				/* Bit shift to only look at page offset */
@@ -29,24 +31,48 @@
 #define LSB_10	0x3FF			
 #define LSB_12	0xFFF	
 #define CR0_PBIT 0x80000000
+#define CR0_WPBIT 0x00010000
 #define CR4_PBIT 0x00000010
+#define CR4_PGEBIT 0x00000080
 #define EXT_BIT 0x80
 #define USER_BIT 0x5
 #define NUM_COLS 80
 #define NUM_ROWS 25
-#define USER_OFFSET 6
+#define IDENT_PDE_START (FRAME_BASE >> D_SHIFT)	/* First PDE of the kernel's view of free RAM */
+#define IDENT_PDE_END (FRAME_LIMIT >> D_SHIFT)		/* One past the last PDE of that view */
+#define USER_PTE_FLAGS 0x7		/* Present, read/write, user privilege */
+#define USER_RO_PTE_FLAGS 0x5	/* Present, read only, user privilege */
+#define PTE_SHARED 0x200		/* Available bit, the frame belongs to the page cache */
+#define PTE_COW 0x400			/* Available bit, the frame is shared until the next write */
+#define PTE_RW 0x2
+#define PTE_GLOBAL 0x100		/* Kept in the TLB across CR3 reloads */
+#define PTE_MMAP 0x800			/* Available bit, the page was mapped by mmap */
+#define MMAP_START 0x08800000	/* User addresses handed out by mmap */
+#define MMAP_END 0x0C800000
+#define PF_WRITE 0x2			/* Page fault error code bit for a write */
+#define PF_PRESENT 0x1			/* Page fault error code bit for a protection fault */
+#define PDE_ADDR_4MB 0xFFC00000	/* Address bits of a 4MB PDE */
 
 /* Function declarations */
 void init_paging(void);
-void map_page(int pd, void * p_addr, void * v_addr, uint32_t flags);
+int32_t new_page_directory(int pd);
+void free_page_directory(int pd);
+int32_t map_page(int pd, void * p_addr, void * v_addr, uint32_t flags);
+void map_text(int pd, int term);
 void ext_map_page(int pd, void * p_addr, void * v_addr, uint32_t flags);
 void ext_unmap_page(int pd, void * v_addr);
 void unmap_page(int pd); 
+uint32_t * get_pte(int pd, void * v_addr);
+int32_t fill_page(pcb_t * pcb, void * v_addr);
+int32_t copy_page_directory(int new_pd, int old_pd);
+int32_t cow_page(int pd, void * v_addr);
+uint32_t find_user_range(int pd, uint32_t start, uint32_t end, uint32_t pages);
+void unmap_user_page(int pd, void * v_addr);
 void flush_tlb(void);
+void flush_tlb_page(void * v_addr);
 void set_page_directory(uint32_t pd);
 void switch_vidmem(uint32_t old, uint32_t new);
 
-extern uint32_t page_directory[MAX_PROCESSES][P_SIZE] __attribute__((aligned(FOUR_KB)));
-extern uint32_t page_table[2 * MAX_PROCESSES - 1][P_SIZE] __attribute__((aligned(FOUR_KB)));
+extern uint32_t * page_directory[MAX_PROCESSES];
 
 #endif /* _PAGING_H */
@@ -0,0 +1,245 @@
+/*
+* pipe.c - fixed size pipes that stream bytes from one task to another,
+*		   readers and writers sleep on wait queues while they cannot go on
+* @Author: Jack Weil, Charles Zega, Rahul Sharma, Saurav Puri
+* @Date:   2016-12-09 15:10:00
+* @Last Modified by:   Jack
+* @Last Modified time: 2016-12-09 15:10:00
+*/
+
+#include "pipe.h"
+
+static pipe_t pipes[NUM_PIPES];
+
+/* File operations tables, the inode_num of a pipe end is its pipe number */
+fops_t pipe_read_operations = {
+	.read = pipe_read,
+	.write = read_end_write,
+	.open = pipe_open,
+	.close = pipe_close
+};
+
+fops_t pipe_write_operations = {
+	.read = write_end_read,
+	.write = pipe_write,
+	.open = pipe_open,
+	.close = pipe_close
+};
+
+/*
+ * pipe_create(file_t * read_end, file_t * write_end)
+ *   DESCRIPTION: Takes a free pipe and opens both of its ends
+ *   INPUTS: read_end - an unused file_t that gets the read end
+ *			 write_end - an unused file_t that gets the write end
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 if every pipe is in use, 0 on success
+ *   SIDE EFFECTS: Fills in both file_t
+ */
+int32_t pipe_create(file_t * read_end, file_t * write_end)
+{
+	uint32_t flags;
+	int32_t i;
+
+	cli_and_save(flags);
+	for(i = 0; i < NUM_PIPES; i++){
+		if(pipes[i].readers == 0 && pipes[i].writers == 0) break;
+	}
+	if(i == NUM_PIPES){
+		restore_flags(flags);
+		return -1;
+	}
+	pipes[i].head = 0;
+	pipes[i].tail = 0;
+	pipes[i].readers = 1;
+	pipes[i].writers = 1;
+	restore_flags(flags);
+
+	memset(read_end, 0, sizeof(file_t));
+	read_end->f_ops = &pipe_read_operations;
+	read_end->inode_num = i;
+	read_end->flags = 1;
+	memset(write_end, 0, sizeof(file_t));
+	write_end->f_ops = &pipe_write_operations;
+	write_end->inode_num = i;
+	write_end->flags = 1;
+	return 0;
+}
+
+/*
+ * is_pipe(file_t * file)
+ *   DESCRIPTION: Tells if an open file is an end of a pipe
+ *   INPUTS: file - the file
+ *   OUTPUTS: none
+ *   RETURN VALUE: 1 for a pipe end, 0 otherwise
+ *   SIDE EFFECTS: none
+ */
+int32_t is_pipe(file_t * file)
+{
+	return file->f_ops == &pipe_read_operations || file->f_ops == &pipe_write_operations;
+}
+
+/*
+ * pipe_dup(file_t * file)
+ *   DESCRIPTION: Counts one more open end after a file_t was copied by fork,
+ *				  execute or copyfd. Does nothing for files that are not pipes.
+ *   INPUTS: file - the new copy
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Changes the reader or writer count of the pipe
+ */
+void pipe_dup(file_t * file)
+{
+	uint32_t flags;
+
+	if(file->flags == 0 || !is_pipe(file)) return;
+
+	cli_and_save(flags);
+	if(file->f_ops == &pipe_read_operations) pipes[file->inode_num].readers++;
+	else pipes[file->inode_num].writers++;
+	restore_flags(flags);
+}
+
+/*
+ * pipe_read(int32_t fd, void* buf, int32_t nbytes)
+ *   DESCRIPTION: Reads whatever is in the pipe up to nbytes, sleeping while
+ *				  it is empty and some write end is still open
+ *   INPUTS: fd - a read end
+ *			 buf - gets the bytes
+ *			 nbytes - the most bytes to read
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 for failure, 0 once every write end is closed and the
+ *				   pipe is drained, the number of bytes read otherwise
+ *   SIDE EFFECTS: Wakes writers waiting for room
+ */
+int32_t pipe_read(int32_t fd, void* buf, int32_t nbytes)
+{
+	file_t * file = &(get_pcb()->file_array[fd]);
+	pipe_t * pipe = &pipes[file->inode_num];
+	uint8_t * dst = (uint8_t *)buf;
+	uint32_t flags;
+	int32_t count;
+
+	if(buf == NULL || nbytes < 0) return -1;
+
+	cli_and_save(flags);
+	while(pipe->head == pipe->tail && pipe->writers != 0){
+		sleep_on(&pipe->read_wait);
+	}
+
+	for(count = 0; count < nbytes && pipe->head != pipe->tail; count++){
+		dst[count] = pipe->buf[pipe->head % PIPE_SIZE];
+		pipe->head++;
+	}
+	if(count != 0) wake_up(&pipe->write_wait);
+	restore_flags(flags);
+	return count;
+}
+
+/*
+ * pipe_write(int32_t fd, const void* buf, int32_t nbytes)
+ *   DESCRIPTION: Writes all nbytes into the pipe, sleeping each time it
+ *				  fills up until a reader makes room
+ *   INPUTS: fd - a write end
+ *			 buf - the bytes to write
+ *			 nbytes - the number of bytes
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 for failure or if every read end is closed before
+ *				   anything was written, the number of bytes written otherwise
+ *   SIDE EFFECTS: Wakes readers waiting for data
+ */
+int32_t pipe_write(int32_t fd, const void* buf, int32_t nbytes)
+{
+	file_t * file = &(get_pcb()->file_array[fd]);
+	pipe_t * pipe = &pipes[file->inode_num];
+	const uint8_t * src = (const uint8_t *)buf;
+	uint32_t flags;
+	int32_t count = 0;
+
+	if(buf == NULL || nbytes < 0) return -1;
+
+	cli_and_save(flags);
+	while(count < nbytes && pipe->readers != 0){
+		if(pipe->tail - pipe->head == PIPE_SIZE){
+			sleep_on(&pipe->write_wait);
+			continue;
+		}
+		while(count < nbytes && pipe->tail - pipe->head < PIPE_SIZE){
+			pipe->buf[pipe->tail % PIPE_SIZE] = src[count];
+			pipe->tail++;
+			count++;
+		}
+		wake_up(&pipe->read_wait);
+	}
+	restore_flags(flags);
+
+	/* Nobody will ever read what is left */
+	if(count == 0 && nbytes != 0) return -1;
+	return count;
+}
+
+/*
+ * write_end_read(int32_t fd, void* buf, int32_t nbytes)
+ *   DESCRIPTION: NOTHING, the write end of a pipe cannot be read
+ *   INPUTS: ignored
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 always
+ *   SIDE EFFECTS: nothing
+ */
+int32_t write_end_read(int32_t fd, void* buf, int32_t nbytes)
+{
+	return -1;
+}
+
+/*
+ * read_end_write(int32_t fd, const void* buf, int32_t nbytes)
+ *   DESCRIPTION: NOTHING, the read end of a pipe cannot be written
+ *   INPUTS: ignored
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 always
+ *   SIDE EFFECTS: nothing
+ */
+int32_t read_end_write(int32_t fd, const void* buf, int32_t nbytes)
+{
+	return -1;
+}
+
+/*
+ * pipe_open(const uint8_t filename)
+ *   DESCRIPTION: Pipes have no name, they are only made by the pipe syscall
+ *   INPUTS: ignored
+ *   OUTPUTS: none
+ *   RETURN VALUE: always -1
+ *   SIDE EFFECTS: none
+ */
+int32_t pipe_open(const uint8_t* filename)
+{
+	return -1;
+}
+
+/*
+ * pipe_close(int32_t fd)
+ *   DESCRIPTION: Closes one end of a pipe, the pipe is free again once
+ *				  both counts reach 0
+ *   INPUTS: fd - a read or write end
+ *   OUTPUTS: none
+ *   RETURN VALUE: always 0 for success
+ *   SIDE EFFECTS: Wakes the other side so it can see the end is gone
+ */
+int32_t pipe_close(int32_t fd)
+{
+	file_t * file = &(get_pcb()->file_array[fd]);
+	pipe_t * pipe = &pipes[file->inode_num];
+	uint32_t flags;
+
+	cli_and_save(flags);
+	if(file->f_ops == &pipe_read_operations){
+		pipe->readers--;
+		wake_up(&pipe->write_wait);
+	}
+	else{
+		pipe->writers--;
+		wake_up(&pipe->read_wait);
+	}
+	restore_flags(flags);
+	return 0;
+}
@@ -0,0 +1,53 @@
+/*
+* pipe.h - header file for pipe.c
+* @Author: Jack Weil, Charles Zega, Rahul Sharma, Saurav Puri
+* @Date:   2016-12-09 15:10:00
+* @Last Modified by:   Jack
+* @Last Modified time: 2016-12-09 15:10:00
+*/
+
+#ifndef _PIPE_H
+#define _PIPE_H
+
+#include "types.h"
+#include "lib.h"
+#include "scheduling.h"
+
+#define NUM_PIPES 8				/* Pipes open at once across all tasks */
+#define PIPE_SIZE 4096			/* Bytes a pipe buffers before writers block */
+#define PIPE_TYPE 3				/* The file type fstat gives a pipe end */
+
+/*
+ * A byte stream between tasks, free while it has no ends open
+ * buf -- the ring buffer
+ * head -- bytes read so far, the slot is head modulo PIPE_SIZE
+ * tail -- bytes written so far, the slot is tail modulo PIPE_SIZE
+ * readers -- open read ends across all tasks
+ * writers -- open write ends across all tasks
+ * read_wait -- readers blocked on an empty pipe
+ * write_wait -- writers blocked on a full pipe
+ */
+typedef struct pipe {
+	uint8_t buf[PIPE_SIZE];
+	uint32_t head;
+	uint32_t tail;
+	uint32_t readers;
+	uint32_t writers;
+	wait_queue_t read_wait;
+	wait_queue_t write_wait;
+} pipe_t;
+
+extern fops_t pipe_read_operations;
+extern fops_t pipe_write_operations;
+
+int32_t pipe_create(file_t * read_end, file_t * write_end);
+void pipe_dup(file_t * file);
+int32_t is_pipe(file_t * file);
+int32_t pipe_read(int32_t fd, void* buf, int32_t nbytes);
+int32_t pipe_write(int32_t fd, const void* buf, int32_t nbytes);
+int32_t write_end_read(int32_t fd, void* buf, int32_t nbytes);
+int32_t read_end_write(int32_t fd, const void* buf, int32_t nbytes);
+int32_t pipe_open(const uint8_t* filename);
+int32_t pipe_close(int32_t fd);
+
+#endif /* _PIPE_H */
@@ -0,0 +1,78 @@
+/*
+* ring.c - a submission and completion ring in a page shared with a user
+*		   program, so one system call can carry many reads and writes
+* @Author: Jack Weil, Charles Zega, Rahul Sharma, Saurav Puri
+* @Date:   2016-12-08 16:20:00
+* @Last Modified by:   Jack
+* @Last Modified time: 2016-12-08 16:20:00
+*/
+
+#include "ring.h"
+
+/* 
+ * ring_setup(pcb_t * pcb)
+ *   DESCRIPTION: Gives a task an empty ring at RING_ADDR
+ *   INPUTS: pcb - the task
+ *   OUTPUTS: none
+ *   RETURN VALUE: 0 on success, -1 if there is no frame for it
+ *   SIDE EFFECTS: Maps the ring's page if it is not mapped yet and clears it
+ */
+int32_t ring_setup(pcb_t * pcb)
+{
+	uint32_t * pte = get_pte(pcb->task_id, (void *)RING_ADDR);
+
+	/* Same as the first touch of a page the program never loaded anything into */
+	if((pte == NULL || !(*pte & PF_PRESENT)) && -1 == fill_page(pcb, (void *)RING_ADDR)) return -1;
+
+	memset((void *)RING_ADDR, 0, sizeof(ring_t));
+	return 0;
+}
+
+/* 
+ * ring_enter(pcb_t * pcb)
+ *   DESCRIPTION: Runs every submission in the task's ring in order, each
+ *				  through the system call it names, and posts a completion
+ *				  for each. Stops early when the completion queue is full.
+ *   INPUTS: pcb - the task
+ *   OUTPUTS: none
+ *   RETURN VALUE: the number of submissions run
+ *   SIDE EFFECTS: whatever the operations do, advances sq_head and cq_tail
+ */
+int32_t ring_enter(pcb_t * pcb)
+{
+	ring_t * ring = (ring_t *)RING_ADDR;
+	ring_sqe_t sqe;
+	ring_cqe_t * cqe;
+	int32_t count = 0;
+
+	while(ring->sq_head != ring->sq_tail && ring->cq_tail - ring->cq_head < RING_ENTRIES){
+		/* Copy the submission first, the program can write the ring any time */
+		sqe = ring->sq[ring->sq_head % RING_ENTRIES];
+		cqe = &ring->cq[ring->cq_tail % RING_ENTRIES];
+		cqe->user_data = sqe.user_data;
+
+		switch(sqe.op){
+			case RING_OP_READ:
+				cqe->result = sys_read(sqe.fd, (void *)sqe.addr, sqe.len);
+				break;
+			case RING_OP_WRITE:
+				cqe->result = sys_write(sqe.fd, (void *)sqe.addr, sqe.len);
+				break;
+			case RING_OP_OPEN:
+				cqe->result = sys_open((uint8_t *)sqe.addr);
+				break;
+			case RING_OP_CLOSE:
+				cqe->result = sys_close(sqe.fd);
+				break;
+			default:
+				cqe->result = -1;
+				break;
+		}
+
+		ring->cq_tail++;
+		ring->sq_head++;
+		count++;
+	}
+
+	return count;
+}
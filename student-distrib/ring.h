@@ -0,0 +1,68 @@
+/*
+* ring.h - header file for ring.c
+* @Author: Jack Weil, Charles Zega, Rahul Sharma, Saurav Puri
+* @Date:   2016-12-08 16:20:00
+* @Last Modified by:   Jack
+* @Last Modified time: 2016-12-08 16:20:00
+*/
+
+#ifndef _RING_H
+#define _RING_H
+
+#include "types.h"
+#include "lib.h"
+#include "paging.h"
+#include "syscall.h"
+
+#define RING_ADDR V_PAGE		/* The ring's page, below where programs load */
+#define RING_ENTRIES 64			/* Slots in each queue, a power of two */
+#define RING_OP_READ 0
+#define RING_OP_WRITE 1
+#define RING_OP_OPEN 2
+#define RING_OP_CLOSE 3
+
+/*
+ * One operation submitted by the program
+ * op -- RING_OP_READ, RING_OP_WRITE, RING_OP_OPEN or RING_OP_CLOSE
+ * fd -- the file, unused by open
+ * addr -- the buffer for read and write, the file name for open
+ * len -- the byte count for read and write
+ * user_data -- handed back untouched in the completion
+ */
+typedef struct ring_sqe {
+	uint32_t op;
+	int32_t fd;
+	uint32_t addr;
+	int32_t len;
+	uint32_t user_data;
+} ring_sqe_t;
+
+/*
+ * One finished operation
+ * user_data -- from the submission
+ * result -- what the matching system call would have returned
+ */
+typedef struct ring_cqe {
+	uint32_t user_data;
+	int32_t result;
+} ring_cqe_t;
+
+/*
+ * The page shared with the program. The program writes submissions at
+ * sq_tail and reads completions at cq_head, the kernel takes submissions
+ * at sq_head and writes completions at cq_tail. The indices count up
+ * forever, the slot is the index modulo RING_ENTRIES.
+ */
+typedef struct ring {
+	uint32_t sq_head;
+	uint32_t sq_tail;
+	uint32_t cq_head;
+	uint32_t cq_tail;
+	ring_sqe_t sq[RING_ENTRIES];
+	ring_cqe_t cq[RING_ENTRIES];
+} ring_t;
+
+int32_t ring_setup(pcb_t * pcb);
+int32_t ring_enter(pcb_t * pcb);
+
+#endif /* _RING_H */
@@ -7,6 +7,12 @@
 */
 #include "rtc.h"
 
+/* Hardware RTC ticks since rtc_init, at MAX_FREQ per second */
+static uint32_t rtc_ticks;
+
+/* Tasks blocked in rtc_read, in the order of the ticks they wait for */
+static wait_queue_t rtc_wait;
+
 /* File operations table */
 fops_t rtc_file_operations = {
 	.read = rtc_read,
@@ -41,6 +47,10 @@ void rtc_init(void)
 	outb(REG_A, REGISTER_PORT);
 	outb((regA & UNIB) | RATE, RW_PORT);
 
+	rtc_ticks = 0;
+	rtc_wait.head = NULL;
+	rtc_wait.tail = NULL;
+
 	/* Turn interrupts back on, including for the RTC */	
 	enable_irq(LOC_OF_RTC);
 }
@@ -48,86 +58,95 @@ void rtc_init(void)
 
 /* 
  * rtc_handler()
- *   DESCRIPTION: Calls test_interrupts and also opens register C
+ *   DESCRIPTION: Counts a hardware tick, opens register C, and wakes the
+ *				  readers whose virtual tick is due
  *   INPUTS: none
  *   OUTPUTS: none
  *   RETURN VALUE: none
- *   SIDE EFFECTS: Will call test_interrupts and open register C
- *				   to ensure that the interrupt will keep happening
+ *   SIDE EFFECTS: Will open register C to ensure that the interrupt will
+ *				   keep happening
  */
 void rtc_handler(void) 
 {
 	/* Port C will hold the info about the interrupt, so check it
 	   to ensure that the interrupt will keep happening, atomically */
-	int i;
 	cli();
 	outb(SELECT_C, REGISTER_PORT);
 	inb(RW_PORT);
 
-	/* The interrupt is over, set flag atomically and acknowledge it */
-	for(i = 0; i < NUM_TERMS; i++){
-		int_has_occurred[i] = 0;
-	}
+	/* Only the readers at the front of the queue can be due */
+	rtc_ticks++;
+	wake_up_due(&rtc_wait, rtc_ticks);
 	sti();
 	send_eoi(LOC_OF_RTC);
 }
 
 /* 
  * rtc_read(int32_t fd, void* buf, int32_t nbytes)
- *   DESCRIPTION: Implements read system call functionality for RTC by waiting
- * 				  until an interrupt has occurred and then returning success
- *   INPUTS: all ignored
+ *   DESCRIPTION: Implements read system call functionality for RTC by sleeping
+ * 				  until the next virtual tick of this file and then returning success
+ *   INPUTS: fd - the RTC file, buf and nbytes are ignored
  *   OUTPUTS: none
  *   RETURN VALUE: always 0 for success
- *   SIDE EFFECTS: clears the file scope int_has_occurred flag
+ *   SIDE EFFECTS: advances the virtual tick of the file
  */
 int32_t rtc_read(int32_t fd, void* buf, int32_t nbytes)
 {
-	/* Wait until an interrupt has occured then reset flag and return 0 */
-	sti();
-	int_has_occurred[get_pcb()->term] = 1;
-	while(int_has_occurred[get_pcb()->term]);
+	file_t * file = &(get_pcb()->file_array[fd]);
+	uint32_t flags;
+
+	cli_and_save(flags);
+	if(file->rtc_div == 0) file->rtc_div = MAX_FREQ / DEFAULT_FREQ;
+
+	/* Wait for the next virtual tick, skipping any that passed while not reading */
+	file->rtc_next += file->rtc_div;
+	if((int32_t)(rtc_ticks - file->rtc_next) >= 0){
+		file->rtc_next += file->rtc_div * ((rtc_ticks - file->rtc_next) / file->rtc_div + 1);
+	}
+
+	/* Sleep until it is due then return 0 */
+	while((int32_t)(rtc_ticks - file->rtc_next) < 0){
+		sleep_on_tick(&rtc_wait, file->rtc_next);
+	}
+	restore_flags(flags);
 	return 0;
 }
 
 /* 
  * rtc_write(int32_t fd, void* buf, int32_t nbytes)
  *   DESCRIPTION: Implements write system call functionality for RTC by setting
- * 				  the frequency of interrupts given by the buf ptr
- *   INPUTS: fd - ignored
+ * 				  the virtual frequency of this file given by the buf ptr
+ *   INPUTS: fd - the RTC file
  *			 const void* buf - ptr to the 4 byte frequency value
  *			 int32_t nbytes - number of bytes to at buf, must be 4
  *   OUTPUTS: none
  *   RETURN VALUE: -1 for failure, nbytes on success
- *   SIDE EFFECTS: sets the frequency of the RTC
+ *   SIDE EFFECTS: sets the tick divider of the file, the hardware rate is untouched
  */
 int32_t rtc_write(int32_t fd, const void* buf, int32_t nbytes)
 {
+	file_t * file = &(get_pcb()->file_array[fd]);
+	uint32_t freq, flags;
+
 	/* Make sure buf is valid ptr to 4 byte value */
 	if(nbytes != SIZEOF_LONG || buf == NULL) return -1;
 
-	/* Byte for saving old/new rate and new freq */
-	uint8_t oldRate, newRate;
-	uint32_t freq;
-
-	/* Get the current rate and new freq */
-	outb(REG_A, REGISTER_PORT);
-	oldRate = inb(RW_PORT);
+	/* Check the validity of the new freq */
 	freq = *((uint32_t*)buf);
+	if(freq_to_rate(freq) == 1) return -1;
 
-	/* Calculate the new rate from the freq and check validity */
-	newRate = freq_to_rate(freq);
-	if(newRate == 1) return -1;
-
-	/* Set the new rate and return num successful bytes */
-	outb(REG_A, REGISTER_PORT);
-	outb((oldRate & UNIB) | newRate, RW_PORT);
+	/* Restart the virtual clock of this file at the new frequency */
+	cli_and_save(flags);
+	file->rtc_div = MAX_FREQ / freq;
+	file->rtc_next = rtc_ticks;
+	restore_flags(flags);
 	return nbytes;
 }
 
 /* 
  * rtc_open(const uint8_t filename)
- *   DESCRIPTION: Implements open system call functionality for RTC 
+ *   DESCRIPTION: Implements open system call functionality for RTC, the file
+ *				  starts at 2 Hz because sys_open clears its tick divider
  *   INPUTS: ignored
  *   OUTPUTS: none
  *   RETURN VALUE: always 0 for success
@@ -135,9 +154,6 @@ int32_t rtc_write(int32_t fd, const void* buf, int32_t nbytes)
  */
 int32_t rtc_open(const uint8_t* filename)
 {
-	/* Initialize the RTC to 2 Hz and return success */
-	int freq = DEFAULT_FREQ;
-	rtc_write(0,&freq,SIZEOF_LONG);
 	return 0;
 }
 
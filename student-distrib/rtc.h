@@ -11,6 +11,7 @@
 
 #include "i8259.h"
 #include "lib.h"
+#include "scheduling.h"
 
 /* Pre-processor definitions */
 #define LOC_OF_RTC    8	   //The port on the PIC
@@ -20,17 +21,15 @@
 #define B_NMI_DIS	  0x8B //Write to REGISTER_PORT to select register B and disable NMI
 #define REG_A		  0x8A //select register A
 #define SELECT_C	  0x0C //Write to REGISTER_PORT to select register C
-#define RATE 		  0xF  // F for 2 Hz
+#define RATE 		  0x6  // 6 for 1024 Hz, the hardware rate never changes
 #define UNIB		  0xF0 // Mask upper nib of byte
+#define MAX_FREQ	  1024 // Hz, the rate the RTC is pinned at
 #define DEFAULT_FREQ  2
 #define SIZEOF_LONG   4
 #define NUM_TERMS	  3
 
 extern fops_t rtc_file_operations;
 
-/* File scope variables */
-uint8_t int_has_occurred[NUM_TERMS];
-
 /* Function delcarations */
 void rtc_init(void);
 void rtc_handler(void);
@@ -11,6 +11,20 @@ int saved_x[NUM_TERMS];
 int saved_y[NUM_TERMS];
 static int FIRST_FLAG;
 
+/* Run queue: one circular list of runnable leaf tasks per priority level,
+   the head of each list is the next task to run at that level. Bit n of
+   rq_bitmap is set when level n is non-empty. */
+static pcb_t * run_queue[NUM_PRIORITIES];
+static uint32_t rq_bitmap;
+
+/* Number of PIT interrupts since init_timer */
+static uint32_t timer_ticks;
+
+/* PCB and kernel stack of the idle task, aligned so get_pcb works on it */
+static uint8_t idle_stack[EIGHT_KB] __attribute__((aligned(EIGHT_KB)));
+
+static uint32_t switch_task(uint32_t* esp);
+
 /* 
  * init_timer(void)
  *   DESCRIPTION: Set the rate of the PIT and the first time term flag
@@ -23,6 +37,78 @@ void init_timer(void)
 {
 	set_rate(SCHEDULING_RATE);
 	FIRST_FLAG = 1;	
+	timer_ticks = 0;
+	init_idle();
+}
+
+/* 
+ * init_idle(void)
+ *   DESCRIPTION: Sets up the idle task and puts it on the lowest run queue
+ *				  level, so it only runs when every other task is blocked
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Changes the run queue
+ */
+void init_idle(void)
+{
+	int i;
+	pcb_t * pcb = (pcb_t *)idle_stack;
+	uint32_t * frame = (uint32_t *)(idle_stack + EIGHT_KB) - IDLE_FRAME_SIZE;
+
+	/* Same layout the timer handler saves, with a kernel level iret */
+	for(i = 0; i < IDLE_FRAME_SIZE; i++){
+		frame[i] = 0;
+	}
+	frame[7] = KERNEL_DS;		/* DS */
+	frame[8] = KERNEL_DS;		/* ES */
+	frame[IDLE_EIP_INDEX] = (uint32_t)idle;
+	frame[10] = KERNEL_CS;		/* CS */
+	frame[11] = IDLE_EFLAGS;	/* EFLAGS, interrupts on */
+
+	/* Runs in the kernel page directory and never has files or children */
+	memset(pcb, 0, sizeof(pcb_t));
+	pcb->task_id = 0;
+	pcb->term = 0;
+	pcb->esp = (uint32_t)frame;
+	pcb->ebp = 0;
+	pcb->priority = IDLE_PRIORITY;
+	pcb->state = TASK_BLOCKED;
+	rq_enqueue(pcb);
+}
+
+/* 
+ * idle(void)
+ *   DESCRIPTION: Body of the idle task, halts until an interrupt and gives
+ *				  the CPU to anything the interrupt woke up
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: never returns
+ *   SIDE EFFECTS: none
+ */
+void idle(void)
+{
+	while(1){
+		asm volatile("sti\n\t"
+				"hlt"
+				:
+				:
+				: "memory", "cc");
+		schedule();
+	}
+}
+
+/* 
+ * get_ticks(void)
+ *   DESCRIPTION: Gets the number of PIT interrupts since boot
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: the tick count, SCHEDULING_RATE ticks per second
+ *   SIDE EFFECTS: none
+ */
+uint32_t get_ticks(void)
+{
+	return timer_ticks;
 }
 
 /* 
@@ -30,30 +116,49 @@ void init_timer(void)
  *   DESCRIPTION: Handler for the PIT that schedules tasks with a round robin algorithm
  *   INPUTS: esp - The esp to save from the PIT interrupt
  *   OUTPUTS: none
- *   RETURN VALUE: none
+ *   RETURN VALUE: the esp of the task to resume
  *   SIDE EFFECTS: Changes scheduling/process structures
  */
 uint32_t irq_timer(uint32_t* esp)
 {
-	int i;
-	pcb_t * old_pcb = get_pcb();
-	pcb_t * new_pcb;
-	i = old_pcb->task_id;
-
 	/* end PIT interrupt */
 	send_eoi(0);
+	timer_ticks++;
 
-	/* if first process not running yet return */
-	if(tasks_bitmap == NO_PROCESSES) return (uint32_t)esp;
+	return switch_task(esp);
+}
+
+/* 
+ * irq_yield(uint32_t * esp)
+ *   DESCRIPTION: Handler for int $YIELD, runs the next task without waiting
+ *				  for the rest of the current time slice
+ *   INPUTS: esp - The esp to save from the yield interrupt
+ *   OUTPUTS: none
+ *   RETURN VALUE: the esp of the task to resume
+ *   SIDE EFFECTS: Changes scheduling/process structures
+ */
+uint32_t irq_yield(uint32_t* esp)
+{
+	return switch_task(esp);
+}
+
+/* 
+ * switch_task(uint32_t * esp)
+ *   DESCRIPTION: Saves the context of the current task and picks the next
+ *				  one off the run queue
+ *   INPUTS: esp - The esp of the saved register frame
+ *   OUTPUTS: none
+ *   RETURN VALUE: the esp of the task to resume
+ *   SIDE EFFECTS: Changes scheduling/process structures
+ */
+static uint32_t switch_task(uint32_t* esp)
+{
+	pcb_t * old_pcb = get_pcb();
+	pcb_t * new_pcb;
 
-	/* Determine the next child process to schedule */
-	do {
-		do {
-			i++;
-			if(i >= MAX_PROCESSES) i = 1;
-		} while(tasks_bitmap & (0x1 << i));
-		new_pcb = (pcb_t *)(EIGHT_MB - EIGHT_KB * i);
-	} while(new_pcb->child != NULL);
+	/* Take the next runnable task, keep running if there is none */
+	new_pcb = rq_next_task();
+	if(new_pcb == NULL) return (uint32_t)esp;
 
 	/* Do nothing if not switching tasks and not the first instance of an OG shell */
 	if((old_pcb->task_id == new_pcb->task_id) && !FIRST_FLAG) return (uint32_t) esp;
@@ -67,8 +172,8 @@ uint32_t irq_timer(uint32_t* esp)
 		screen_y = saved_y[new_pcb->term];
 	}
 
-	/* Set the the TSS esp0 */
-	tss.esp0 = EIGHT_MB - (new_pcb->task_id-1)*EIGHT_KB - 1;
+	/* Set the the TSS esp0 to the top of the new task's kernel stack */
+	set_kernel_stack((uint32_t)new_pcb + EIGHT_KB - 1);
 	
 	/* stack swipswap */
 	if(!FIRST_FLAG){
@@ -103,3 +208,241 @@ void set_first_flag(int flag)
 	FIRST_FLAG = flag;
 }
 
+/* 
+ * rq_enqueue(pcb_t * pcb)
+ *   DESCRIPTION: Puts a task at the tail of the run queue for its priority
+ *   INPUTS: pcb - the task that is now runnable
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Changes the run queue, does nothing if already queued
+ */
+void rq_enqueue(pcb_t * pcb)
+{
+	uint32_t flags;
+	pcb_t * head;
+
+	cli_and_save(flags);
+	if(pcb->state == TASK_RUNNABLE){
+		restore_flags(flags);
+		return;
+	}
+
+	/* Link in just before the head, which is the tail of the circular list */
+	head = run_queue[pcb->priority];
+	if(head == NULL){
+		pcb->rq_next = pcb;
+		pcb->rq_prev = pcb;
+		run_queue[pcb->priority] = pcb;
+		rq_bitmap |= 0x1 << pcb->priority;
+	}
+	else{
+		pcb->rq_next = head;
+		pcb->rq_prev = head->rq_prev;
+		head->rq_prev->rq_next = pcb;
+		head->rq_prev = pcb;
+	}
+	pcb->state = TASK_RUNNABLE;
+	restore_flags(flags);
+}
+
+/* 
+ * rq_dequeue(pcb_t * pcb)
+ *   DESCRIPTION: Takes a task off the run queue so it will not be scheduled
+ *   INPUTS: pcb - the task that is blocking, waiting, or halting
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Changes the run queue, does nothing if not queued
+ */
+void rq_dequeue(pcb_t * pcb)
+{
+	uint32_t flags;
+
+	cli_and_save(flags);
+	if(pcb->state != TASK_RUNNABLE){
+		restore_flags(flags);
+		return;
+	}
+
+	/* Unlink, emptying the level if this was its only task */
+	if(pcb->rq_next == pcb){
+		run_queue[pcb->priority] = NULL;
+		rq_bitmap &= ~(0x1 << pcb->priority);
+	}
+	else{
+		pcb->rq_prev->rq_next = pcb->rq_next;
+		pcb->rq_next->rq_prev = pcb->rq_prev;
+		if(run_queue[pcb->priority] == pcb) run_queue[pcb->priority] = pcb->rq_next;
+	}
+	pcb->rq_next = NULL;
+	pcb->rq_prev = NULL;
+	pcb->state = TASK_BLOCKED;
+	restore_flags(flags);
+}
+
+/* 
+ * rq_next_task(void)
+ *   DESCRIPTION: Picks the head of the highest priority non-empty level and
+ *				  rotates that level so the picked task goes to the tail
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: the task to run next, NULL if nothing is runnable
+ *   SIDE EFFECTS: Rotates one level of the run queue
+ */
+pcb_t * rq_next_task(void)
+{
+	uint32_t flags, level;
+	pcb_t * pcb;
+
+	cli_and_save(flags);
+	if(rq_bitmap == 0){
+		restore_flags(flags);
+		return NULL;
+	}
+
+	/* Lowest set bit is the highest priority level with a task on it */
+	asm volatile("bsfl %1, %0"
+			: "=r"(level)
+			: "r"(rq_bitmap)
+			: "cc");
+	pcb = run_queue[level];
+	run_queue[level] = pcb->rq_next;
+	restore_flags(flags);
+	return pcb;
+}
+
+
+/* 
+ * schedule(void)
+ *   DESCRIPTION: Gives up the CPU to the next task on the run queue, returns
+ *				  once this task is picked again (right away if nothing else
+ *				  is runnable)
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Switches tasks
+ */
+void schedule(void)
+{
+	asm volatile("int %0"
+			:
+			: "i"(YIELD)
+			: "memory", "cc");
+}
+
+/* 
+ * sleep_on(wait_queue_t * wq)
+ *   DESCRIPTION: Blocks the current task on a wait queue, off the run queue,
+ *				  until wake_up is called on it. Callers check their wake
+ *				  condition with interrupts off and loop around sleep_on.
+ *   INPUTS: wq - the event to wait for
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Switches tasks
+ */
+void sleep_on(wait_queue_t * wq)
+{
+	uint32_t flags;
+	pcb_t * pcb = get_pcb();
+
+	cli_and_save(flags);
+
+	/* Add to the tail of the wait queue */
+	pcb->wq_next = NULL;
+	if(wq->tail == NULL) wq->head = pcb;
+	else wq->tail->wq_next = pcb;
+	wq->tail = pcb;
+	rq_dequeue(pcb);
+
+	/* Run something else until woken, the idle task is always there to run */
+	while(pcb->state != TASK_RUNNABLE){
+		schedule();
+	}
+	restore_flags(flags);
+}
+
+/* 
+ * wake_up(wait_queue_t * wq)
+ *   DESCRIPTION: Puts every task sleeping on a wait queue back on the run queue
+ *   INPUTS: wq - the event that happened
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Empties the wait queue
+ */
+void wake_up(wait_queue_t * wq)
+{
+	uint32_t flags;
+	pcb_t * pcb;
+
+	cli_and_save(flags);
+	while(wq->head != NULL){
+		pcb = wq->head;
+		wq->head = pcb->wq_next;
+		pcb->wq_next = NULL;
+		rq_enqueue(pcb);
+	}
+	wq->tail = NULL;
+	restore_flags(flags);
+}
+
+/* 
+ * sleep_on_tick(wait_queue_t * wq, uint32_t tick)
+ *   DESCRIPTION: Like sleep_on, but the queue is kept in the order of the
+ *				  ticks its tasks wait for so wake_up_due only has to look
+ *				  at the front of it
+ *   INPUTS: wq - the queue, only used with these two functions
+ *			 tick - the tick to wait for
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Switches tasks
+ */
+void sleep_on_tick(wait_queue_t * wq, uint32_t tick)
+{
+	uint32_t flags;
+	pcb_t * pcb = get_pcb();
+	pcb_t * prev = NULL;
+	pcb_t * curr;
+
+	cli_and_save(flags);
+
+	/* Go after every task waiting for the same tick or an earlier one */
+	pcb->wake_tick = tick;
+	for(curr = wq->head; curr != NULL && (int32_t)(curr->wake_tick - tick) <= 0; curr = curr->wq_next){
+		prev = curr;
+	}
+	pcb->wq_next = curr;
+	if(prev == NULL) wq->head = pcb;
+	else prev->wq_next = pcb;
+	if(curr == NULL) wq->tail = pcb;
+	rq_dequeue(pcb);
+
+	while(pcb->state != TASK_RUNNABLE){
+		schedule();
+	}
+	restore_flags(flags);
+}
+
+/* 
+ * wake_up_due(wait_queue_t * wq, uint32_t now)
+ *   DESCRIPTION: Puts the tasks on a queue from sleep_on_tick whose tick has
+ *				  come back on the run queue, the rest keep sleeping
+ *   INPUTS: wq - the queue
+ *			 now - the current tick
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Takes the woken tasks off the front of the queue
+ */
+void wake_up_due(wait_queue_t * wq, uint32_t now)
+{
+	uint32_t flags;
+	pcb_t * pcb;
+
+	cli_and_save(flags);
+	while(wq->head != NULL && (int32_t)(now - wq->head->wake_tick) >= 0){
+		pcb = wq->head;
+		wq->head = pcb->wq_next;
+		pcb->wq_next = NULL;
+		rq_enqueue(pcb);
+	}
+	if(wq->head == NULL) wq->tail = NULL;
+	restore_flags(flags);
+}
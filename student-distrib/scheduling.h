@@ -25,12 +25,42 @@
 #define BYTE_SHIFT 8
 #define LSB_BYTE 0xFF
 #define EBP_INDEX 5
+#define NUM_PRIORITIES 4
+#define DEFAULT_PRIORITY 1
+#define IDLE_PRIORITY (NUM_PRIORITIES - 1)
+#define IDLE_EFLAGS 0x202
+#define IDLE_FRAME_SIZE 12
+#define IDLE_EIP_INDEX 9
+#define TASK_BLOCKED 0
+#define TASK_RUNNABLE 1
+
+/*
+ * A list of tasks blocked on one event
+ * head -- the first task to have gone to sleep
+ * tail -- the last task to have gone to sleep
+ */
+typedef struct wait_queue {
+	pcb_t * head;
+	pcb_t * tail;
+} wait_queue_t;
 
 /* Local functions */
 void init_timer(void);
+void init_idle(void);
+void idle(void);
+uint32_t get_ticks(void);
 uint32_t irq_timer(uint32_t* esp);
+uint32_t irq_yield(uint32_t* esp);
 void set_rate(int hz);
 void set_first_flag(int flag);
+void rq_enqueue(pcb_t * pcb);
+void rq_dequeue(pcb_t * pcb);
+pcb_t * rq_next_task(void);
+void schedule(void);
+void sleep_on(wait_queue_t * wq);
+void wake_up(wait_queue_t * wq);
+void sleep_on_tick(wait_queue_t * wq, uint32_t tick);
+void wake_up_due(wait_queue_t * wq, uint32_t now);
 
 extern int saved_x[NUM_TERMS];
 extern int saved_y[NUM_TERMS];
@@ -0,0 +1,148 @@
+/*
+* scrollback.c - keeps the lines that scroll off the top of each terminal
+*				 and shows them again on Shift+PgUp/PgDn
+* @Author: Jack Weil, Charles Zega, Rahul Sharma, Saurav Puri
+* @Date:   2016-12-10 13:30:00
+* @Last Modified by:   Jack
+* @Last Modified time: 2016-12-10 13:30:00
+*/
+
+#include "scrollback.h"
+
+static scrollback_t history[TEXT_REGIONS];
+
+/* Lines the display is scrolled back from the bottom of the active
+   terminal's screen, 0 while it shows the live screen */
+static uint32_t view_lines;
+
+/*
+ * scrollback_init(void)
+ *   DESCRIPTION: Gives each terminal an empty history
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Takes SCROLLBACK_FRAMES frames per terminal, a terminal
+ *				   the allocator cannot serve just keeps no history
+ */
+void scrollback_init(void)
+{
+	int i;
+
+	for(i = 0; i < TEXT_REGIONS; i++){
+		history[i].lines = (uint8_t *)alloc_frames(SCROLLBACK_FRAMES, 1);
+		history[i].head = 0;
+	}
+	view_lines = 0;
+}
+
+/*
+ * scrollback_push(uint32_t term)
+ *   DESCRIPTION: Adds a line to the end of a terminal's history, writing
+ *				  over the oldest one once the ring is full
+ *   INPUTS: term - the terminal
+ *   OUTPUTS: none
+ *   RETURN VALUE: the ROW_BYTES the caller fills in, NULL if the terminal
+ *				   keeps no history
+ *   SIDE EFFECTS: none
+ */
+uint8_t * scrollback_push(uint32_t term)
+{
+	scrollback_t * sb = &history[term];
+	uint8_t * line;
+
+	if(sb->lines == NULL) return NULL;
+
+	line = sb->lines + (sb->head % SCROLLBACK_LINES) * ROW_BYTES;
+	sb->head++;
+	return line;
+}
+
+/*
+ * scrollback_line(uint32_t term, uint32_t back)
+ *   DESCRIPTION: Finds a line in a terminal's history counting back from
+ *				  the newest one
+ *   INPUTS: term - the terminal
+ *			 back - 1 for the newest line
+ *   OUTPUTS: none
+ *   RETURN VALUE: the line, NULL if it is not kept
+ *   SIDE EFFECTS: none
+ */
+uint8_t * scrollback_line(uint32_t term, uint32_t back)
+{
+	scrollback_t * sb = &history[term];
+
+	if(sb->lines == NULL || back == 0 || back > sb->head || back > SCROLLBACK_LINES) return NULL;
+	return sb->lines + ((sb->head - back) % SCROLLBACK_LINES) * ROW_BYTES;
+}
+
+/*
+ * scrollback_view(uint32_t term, int32_t lines)
+ *   DESCRIPTION: Scrolls the view of the active terminal back into its
+ *				  history, or forward for negative lines, and draws the
+ *				  NUM_ROWS lines it now covers into the view region. Going
+ *				  forward past the live screen shows the live screen.
+ *   INPUTS: term - the active terminal
+ *			 lines - how far to move
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Moves the VGA display start
+ */
+void scrollback_view(uint32_t term, int32_t lines)
+{
+	scrollback_t * sb = &history[term];
+	uint32_t kept = (sb->head < SCROLLBACK_LINES) ? sb->head : SCROLLBACK_LINES;
+	uint8_t * view = (uint8_t *)(VMEM_OFFSET + VIEW_REGION * TEXT_BYTES);
+	int32_t pos;
+	int y;
+
+	if(sb->lines == NULL) return;
+
+	/* Stay between the oldest line kept and the live screen */
+	pos = (int32_t)view_lines + lines;
+	if(pos < 0) pos = 0;
+	if(pos > (int32_t)kept) pos = kept;
+	if(pos == 0){
+		scrollback_end(term);
+		return;
+	}
+	view_lines = pos;
+
+	/* History lines first then the top of the live screen, in the kernel's
+	   address space where every region is at its own address */
+	set_page_directory(0);
+	for(y = 0; y < NUM_ROWS; y++){
+		if(y < pos) memcpy(view + y * ROW_BYTES, scrollback_line(term, pos - y), ROW_BYTES);
+		else memcpy(view + y * ROW_BYTES, text_row(term, y - pos), ROW_BYTES);
+	}
+	set_page_directory(get_pcb()->task_id);
+
+	set_text_start(VIEW_REGION * (TEXT_BYTES / 2));
+}
+
+/*
+ * scrollback_end(uint32_t term)
+ *   DESCRIPTION: Puts the live screen of the active terminal back on the
+ *				  display if its history is being viewed
+ *   INPUTS: term - the active terminal
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Moves the VGA display start
+ */
+void scrollback_end(uint32_t term)
+{
+	if(view_lines != 0) show_text(term);
+}
+
+/*
+ * scrollback_live(void)
+ *   DESCRIPTION: Notes that the display shows a live screen again, called
+ *				  by show_text
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: none
+ */
+void scrollback_live(void)
+{
+	view_lines = 0;
+}
@@ -0,0 +1,39 @@
+/*
+* scrollback.h - header file for scrollback.c
+* @Author: Jack Weil, Charles Zega, Rahul Sharma, Saurav Puri
+* @Date:   2016-12-10 13:30:00
+* @Last Modified by:   Jack
+* @Last Modified time: 2016-12-10 13:30:00
+*/
+
+#ifndef _SCROLLBACK_H
+#define _SCROLLBACK_H
+
+#include "types.h"
+#include "lib.h"
+#include "frame_alloc.h"
+#include "paging.h"
+
+#define SCROLLBACK_LINES 10240		/* Lines of history each terminal keeps */
+#define SCROLLBACK_FRAMES (SCROLLBACK_LINES * ROW_BYTES / FRAME_SIZE)
+
+/*
+ * The history of one terminal, a ring of screen lines
+ * lines -- SCROLLBACK_LINES rows of character and attribute cells, NULL if
+ *			there was no memory for them
+ * head -- lines kept so far, the next one goes in slot head modulo
+ *		   SCROLLBACK_LINES
+ */
+typedef struct scrollback {
+	uint8_t * lines;
+	uint32_t head;
+} scrollback_t;
+
+void scrollback_init(void);
+uint8_t * scrollback_push(uint32_t term);
+uint8_t * scrollback_line(uint32_t term, uint32_t back);
+void scrollback_view(uint32_t term, int32_t lines);
+void scrollback_end(uint32_t term);
+void scrollback_live(void);
+
+#endif /* _SCROLLBACK_H */
@@ -6,9 +6,113 @@
 */
 
 #include "syscall.h"
+#include "ring.h"
+#include "pipe.h"
 
-/* File scope variables */
-uint8_t tasks_bitmap = NO_PROCESSES;
+/* File scope variables, bit n of tasks_bitmap is set while task id n is in
+   use and task id 0 always belongs to the kernel */
+static uint32_t tasks_bitmap[TASK_MAP_SIZE] = {0x1};
+
+/* Set once the processor is known to have SYSENTER and its MSRs are loaded */
+static uint32_t sysenter_ok = 0;
+
+/* 
+ * init_sysenter(void)
+ *   DESCRIPTION: Points SYSENTER at sysenter_handler if the processor has
+ *				  it, the code segment and entry point are the same for
+ *				  every task so only the stack changes later
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Writes the SYSENTER MSRs, without them SYSENTER faults
+ *				   and user programs have to use int $0x80
+ */
+void init_sysenter(void)
+{
+	uint32_t eax, ebx, ecx, edx;
+
+	asm volatile("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(CPUID_FEATURES));
+	if(!(edx & CPUID_SEP)) return;
+
+	asm volatile("wrmsr" : : "c"(SYSENTER_CS_MSR), "a"(KERNEL_CS), "d"(0));
+	asm volatile("wrmsr" : : "c"(SYSENTER_EIP_MSR), "a"(sysenter_handler), "d"(0));
+	sysenter_ok = 1;
+	set_kernel_stack(tss.esp0);
+}
+
+/* 
+ * set_kernel_stack(uint32_t esp0)
+ *   DESCRIPTION: Sets the stack the next system call or interrupt from user
+ *				  level starts on, for both INT $0x80 and SYSENTER
+ *   INPUTS: esp0 - top of the running task's kernel stack
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Changes the TSS esp0 and the SYSENTER_ESP MSR
+ */
+void set_kernel_stack(uint32_t esp0)
+{
+	tss.esp0 = esp0;
+	if(sysenter_ok) asm volatile("wrmsr" : : "c"(SYSENTER_ESP_MSR), "a"(esp0), "d"(0));
+}
+
+/* 
+ * find_task_id(void)
+ *   DESCRIPTION: Finds the lowest task id (and associated PD and PCB) that
+ *				  is not in use
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: the task id, -1 if all MAX_PROCESSES are in use
+ *   SIDE EFFECTS: none
+ */
+int32_t find_task_id(void)
+{
+	int pd;
+	for(pd = 1; pd < MAX_PROCESSES; pd++){
+		if(!task_running(pd)) return pd;
+	}
+	return -1;
+}
+
+/* 
+ * claim_task_id(int pd)
+ *   DESCRIPTION: Marks a task id as in use
+ *   INPUTS: pd - the task id
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Changes the tasks bitmap
+ */
+void claim_task_id(int pd)
+{
+	tasks_bitmap[pd / BITS_PER_LONG] |= 0x1 << (pd % BITS_PER_LONG);
+}
+
+/* 
+ * release_task_id(int pd)
+ *   DESCRIPTION: Marks a task id as free to be given to a new process
+ *   INPUTS: pd - the task id
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: Changes the tasks bitmap
+ */
+void release_task_id(int pd)
+{
+	tasks_bitmap[pd / BITS_PER_LONG] &= ~(0x1 << (pd % BITS_PER_LONG));
+}
+
+/* 
+ * task_running(int pd)
+ *   DESCRIPTION: Checks whether a task id belongs to a live process, which
+ *				  tells if the PCB at that id can be trusted
+ *   INPUTS: pd - the task id
+ *   OUTPUTS: none
+ *   RETURN VALUE: 1 if the task id is in use, 0 if not
+ *   SIDE EFFECTS: none
+ */
+int32_t task_running(int pd)
+{
+	if(pd < 0 || pd >= MAX_PROCESSES) return 0;
+	return (tasks_bitmap[pd / BITS_PER_LONG] >> (pd % BITS_PER_LONG)) & 0x1;
+}
 
 /* 
  * sys_halt(uint8_t status)
@@ -25,9 +129,12 @@ int32_t sys_halt(uint8_t status)
 	pcb_t * parent;
 	uint32_t i, parent_esp, parent_ebp;
 
-	/* Mark all files as not in use */
+	/* This task will never be scheduled again */
+	rq_dequeue(pcb);
+
+	/* Mark all files as not in use, stdin and stdout may be pipe ends */
 	for(i = 0; i < NUM_FILES; i++){
-		if(pcb->file_array[i].flags == 1) sys_close(i);
+		if(pcb->file_array[i].flags == 1) release_file(i);
 	}
 	pcb->ebp = 0;
 	pcb->esp = 0;
@@ -41,10 +148,10 @@ int32_t sys_halt(uint8_t status)
 	/* These are things that only need to be done if called this is a child of a shell */
 	if(pcb->parent != NULL){
 		parent = pcb->parent;
-		tss.esp0 = EIGHT_MB - (pcb->parent->task_id-1)*EIGHT_KB - 1;
+		set_kernel_stack(EIGHT_MB - (pcb->parent->task_id-1)*EIGHT_KB - 1);
 		set_page_directory(parent->task_id);
-		ext_unmap_page(pcb->task_id,(uint8_t*)V_PAGE);
         parent->child = NULL;
+		rq_enqueue(parent);
 		parent_esp = parent->esp;
 		parent_ebp = parent->ebp;
 	}
@@ -52,19 +159,24 @@ int32_t sys_halt(uint8_t status)
 	else{
 		set_page_directory(0);
 	}
-	/* Set the current process as no longer running */
-	tasks_bitmap |= 0x1 << pcb->task_id;
+	/* Give back the address space and set the current process as no longer running */
+	free_page_directory(pcb->task_id);
+	release_task_id(pcb->task_id);
 
-	/* If you are an OG shell just restart */
+	/* If you are an OG shell just restart, a forked process just goes away */
 	if(pcb->parent == NULL){
-		screen_x = 0;
-		screen_y = 0;
-		saved_x[get_active_term()] = 0;
-		saved_y[get_active_term()] = 0;
-		sys_fork();
+		if(!pcb->forked){
+			screen_x = 0;
+			screen_y = 0;
+			saved_x[get_active_term()] = 0;
+			saved_y[get_active_term()] = 0;
+			spawn_shell();
+		}
+
+		/* Leave this stack for good, the new shell or the next task runs next */
 		set_first_flag(1);
-		sti();
-		while(1);
+		schedule();
+		while(1) asm volatile("hlt");
 	}
 
 	pcb->task_id = 0;
@@ -99,7 +211,8 @@ int32_t sys_execute(const uint8_t* command)
 {
 	/* Local variables */
 	uint8_t file_name[FNAME_SIZE];
-	int i, pd = 0, user_stack, p_addr, v_addr;
+	int i, pd, user_stack, v_addr;
+	pcb_t pcb;
 	char local_args[ARG_BYTES];
 	int local_arglength = 1;
 
@@ -115,7 +228,7 @@ int32_t sys_execute(const uint8_t* command)
 	file_name[i] = '\0';
 
 	/* Determine the first available process id (and associated PD) */
-	while((tasks_bitmap & (0x1 << pd)) == 0) pd++;
+	pd = find_task_id();
 
 	/* Get the arguments into the PCB */
 	while(command[i] == ' ') i++;
@@ -129,31 +242,25 @@ int32_t sys_execute(const uint8_t* command)
 	local_args[i] = '\0';
 
 	/* Load the program */
-	p_addr = FOUR_MB + FOUR_MB*pd;
-	if(-1 == load_program(pd, (void *)p_addr, (void *)(&v_addr), file_name)) return -1;
+	if(-1 == load_program(pd, (void *)(&v_addr), &pcb, file_name)) return -1;
 
-	/* Toggle the bitmask bit */
-	tasks_bitmap ^= 0x1 << pd;
+	/* Mark the task id in use */
+	claim_task_id(pd);
 
-	/* Map the appropriate vmem page in */
-	map_page(pd, (void*)VMEM_OFFSET, (void*)VMEM_OFFSET, (uint32_t)VMEM_PDE);
+	/* Map the text region of the caller's terminal in */
+	map_text(pd, get_pcb()->term);
 
 	/* Set the the TSS ss0 and esp0 */
-	tss.esp0 = EIGHT_MB - (pd-1)*EIGHT_KB - 1;
+	set_kernel_stack(EIGHT_MB - (pd-1)*EIGHT_KB - 1);
 	
-	/* Create a PCB and initialize it for the child */
-	pcb_t pcb;
+	/* Initialize the rest of the PCB for the child */
 	strncpy((int8_t*)pcb.arg,(int8_t*)local_args,local_arglength);
 
-	/* Set up stdin and stdout */
-	pcb.file_array[0].f_ops = &term_file_operations;
-	pcb.file_array[0].inode_num = 0;
-	pcb.file_array[0].file_pos = 0;
-	pcb.file_array[0].flags = 1;
-	pcb.file_array[1].f_ops = &term_file_operations;
-	pcb.file_array[1].inode_num = 0;
-	pcb.file_array[1].file_pos = 0;
-	pcb.file_array[1].flags = 1;
+	/* Inherit stdin and stdout, so a shell can point them at a pipe */
+	pcb.file_array[0] = get_pcb()->file_array[0];
+	pcb.file_array[1] = get_pcb()->file_array[1];
+	pipe_dup(&pcb.file_array[0]);
+	pipe_dup(&pcb.file_array[1]);
 
 	/* The rest of the file_array should be initialized to empty */
 	for(i = STDOUT; i < NUM_FILES; i++){
@@ -174,6 +281,10 @@ int32_t sys_execute(const uint8_t* command)
 	pcb.parent->child = (pcb_t*)(EIGHT_MB - pd*EIGHT_KB);
 	pcb.child = NULL;
 	pcb.arg_len = local_arglength;
+	pcb.forked = 0;
+	pcb.ring = 0;
+	pcb.priority = DEFAULT_PRIORITY;
+	pcb.state = TASK_BLOCKED;
 
 	/* Set the location of the user addr space */
 	user_stack = V_PAGE + FOUR_MB - 1;
@@ -190,6 +301,10 @@ int32_t sys_execute(const uint8_t* command)
 	/* copy filled out pcb to memory */
 	memcpy((void*)(EIGHT_MB - pd*EIGHT_KB),(void*)&pcb, sizeof(pcb_t));
 
+	/* The parent waits off the run queue until the child halts */
+	rq_dequeue(pcb.parent);
+	rq_enqueue(pcb.parent->child);
+
 	/* inline assembly for iret routine */
 	__asm__ volatile("\n\t"
 				 "execute:\n\t"
@@ -218,35 +333,35 @@ int32_t sys_execute(const uint8_t* command)
 }
 
 /* 
- * sys_fork(const uint8_t* command)
- *   DESCRIPTION: Sets up the pcb for the new task that is to be executed, copies
- *				  the code to be executed to the location where it starts,
- *				  sets up virtual memory for the new task, but does not iret
- *   INPUTS: command - the string that tells which program to execute
+ * spawn_shell(void)
+ *   DESCRIPTION: Sets up the pcb for a new OG shell in the active terminal,
+ *				  sets up virtual memory for the new task and leaves it on
+ *				  the run queue for the scheduler, but does not iret
+ *   INPUTS: none
  *   OUTPUTS: none
  *   RETURN VALUE: -1 for failure, 0 on success
  *   SIDE EFFECTS: Alters the TSS and several processor registers, alters memory
  */
-int32_t sys_fork(void)
+int32_t spawn_shell(void)
 {
-	int i, pd = 0, old_pd = 0, p_addr, v_addr, k_stack;
+	int i, pd, old_pd = 0, v_addr, k_stack;
+	pcb_t pcb;
 
-	/* Determine the first available process id (and associated PD) */
-	while((tasks_bitmap & (0x1 << pd)) == 0) pd++;
-	if(pd != 1) old_pd = get_pcb()->task_id;
+	/* Determine the first available process id (and associated PD), come
+	   back to the caller's address space unless it is a halted OG shell */
+	pd = find_task_id();
+	if(pd != 1 && task_running(get_pcb()->task_id)) old_pd = get_pcb()->task_id;
 
 	/* Load the program */
-	p_addr = FOUR_MB + FOUR_MB*pd;
-	if(-1 == load_program(pd, (void *)p_addr, (void *)(&v_addr), (uint8_t *)"shell")) return -1;
+	if(-1 == load_program(pd, (void *)(&v_addr), &pcb, (uint8_t *)"shell")) return -1;
 
-	/* Map the appropriate vmem page in */
-	map_page(pd, (void*)VMEM_OFFSET, (void*)VMEM_OFFSET, (uint32_t)VMEM_PDE);
+	/* Map the text region of the active terminal in */
+	map_text(pd, get_active_term());
 
-	/* Toggle the bitmask bit */
-	tasks_bitmap ^= 0x1 << pd;
+	/* Mark the task id in use */
+	claim_task_id(pd);
 
-	/* Create a PCB and initialize it for the child */
-	pcb_t pcb;
+	/* Initialize the rest of the PCB for the child */
 	for(i = 0; i < ARG_BYTES; i++) 
 		pcb.arg[i] = '\0';
 
@@ -277,6 +392,10 @@ int32_t sys_fork(void)
 	pcb.parent = NULL;
 	pcb.term = get_active_term();
 	pcb.child = NULL;
+	pcb.forked = 0;
+	pcb.ring = 0;
+	pcb.priority = DEFAULT_PRIORITY;
+	pcb.state = TASK_BLOCKED;
 
 	/* Set up the context for the IRET into the process by the scheduler */
 	k_stack = EIGHT_MB - (pd-1)*EIGHT_KB - 1 - REG_SIZE * sizeof(uint32_t);
@@ -317,8 +436,9 @@ int32_t sys_fork(void)
 	pcb.ebp = EIGHT_MB - (pd-1)*EIGHT_KB - 1;
 	pcb.esp = k_stack;
 
-	/* Copy filled out pcb to memory */
+	/* Copy filled out pcb to memory and let the scheduler pick it up */
 	memcpy((void*)(EIGHT_MB - pd*EIGHT_KB),(void*)&pcb, sizeof(pcb_t));
+	rq_enqueue((pcb_t *)(EIGHT_MB - pd*EIGHT_KB));
 
 	/* Initialize terminal screen */
 	clear();
@@ -329,33 +449,91 @@ int32_t sys_fork(void)
 }
 
 /* 
- * load_program(int pd, void * p_addr, uint8_t * file_name)
- *   DESCRIPTION: Sets up virtual memory for a new process and copies
- *				  code to that location
- *   INPUTS: pd -- the page directory to swap to
- *			 p_addr -- the physical address to copy the memory to
+ * sys_fork(void)
+ *   DESCRIPTION: Makes a copy of the calling process. The user pages are
+ *				  shared copy-on-write, the files and arguments are copied,
+ *				  and the child resumes from the same int $0x80 with 0 in
+ *				  EAX. Nobody waits for the child, it halts on its own.
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 for failure, the task id of the child to the parent
+ *   SIDE EFFECTS: Marks the writable user pages of the caller read-only
+ */
+int32_t sys_fork(void)
+{
+	int i, pd;
+	pcb_t * parent = get_pcb();
+	pcb_t * child;
+	uint32_t * k_stack;
+	uint32_t * u_frame = (uint32_t *)(tss.esp0 - SYSCALL_FRAME_SIZE * sizeof(uint32_t));
+
+	/* Get a task id and an address space that shares the caller's pages */
+	pd = find_task_id();
+	if(pd == -1 || -1 == new_page_directory(pd)){
+		term_write(0,(void*)err_proc,strlen((int8_t*)err_proc));
+		return -1;
+	}
+	if(-1 == copy_page_directory(pd, parent->task_id)){
+		free_page_directory(pd);
+		term_write(0,(void*)err_proc,strlen((int8_t*)err_proc));
+		return -1;
+	}
+	claim_task_id(pd);
+
+	/* Start from a copy of the caller's PCB */
+	child = (pcb_t *)(EIGHT_MB - pd*EIGHT_KB);
+	memcpy((void *)child, (void *)parent, sizeof(pcb_t));
+	child->task_id = pd;
+	child->parent = NULL;
+	child->child = NULL;
+	child->forked = 1;
+	child->state = TASK_BLOCKED;
+	for(i = 0; i < NUM_FILES; i++){
+		pipe_dup(&child->file_array[i]);
+	}
+
+	/* Turn the caller's int $0x80 frame into a scheduler frame returning 0 */
+	k_stack = (uint32_t *)(EIGHT_MB - (pd-1)*EIGHT_KB - 1 - REG_SIZE * sizeof(uint32_t));
+	k_stack[0] = u_frame[0];		/* EBX */
+	k_stack[1] = u_frame[1];		/* ECX */
+	k_stack[2] = u_frame[2];		/* EDX */
+	k_stack[3] = u_frame[3];		/* ESI */
+	k_stack[4] = u_frame[4];		/* EDI */
+	k_stack[5] = u_frame[5];		/* EBP */
+	k_stack[6] = 0;					/* EAX */
+	k_stack[7] = u_frame[6];		/* DS */
+	k_stack[8] = u_frame[7];		/* ES */
+	k_stack[9] = u_frame[8];		/* EIP */
+	k_stack[10] = u_frame[9];		/* CS */
+	k_stack[11] = u_frame[10];		/* EFLAGS */
+	k_stack[12] = u_frame[11];		/* ESP */
+	k_stack[13] = u_frame[12];		/* SS */
+	child->ebp = EIGHT_MB - (pd-1)*EIGHT_KB - 1;
+	child->esp = (uint32_t)k_stack;
+
+	rq_enqueue(child);
+	return pd;
+}
+
+/* 
+ * load_program(int pd, void * v_addr, pcb_t * pcb, uint8_t * file_name)
+ *   DESCRIPTION: Sets up virtual memory for a new process. The user pages
+ *				  start out not present and page_fault fills them from the
+ *				  program file the first time they are touched.
+ *   INPUTS: pd -- the task id of the new process, -1 if none are free
+ *			 v_addr -- gets the entry point of the program
+ *			 pcb -- gets the program image fields of the new process
  *			 file_name -- the name of the file to execute
  *   OUTPUTS: none
  *   RETURN VALUE: -1 for failure, 0 on success
- *   SIDE EFFECTS: Alters cr3 and loads the program to virtual memory
+ *   SIDE EFFECTS: Allocates a page directory and alters cr3
  */
-int32_t load_program(int pd, void * p_addr, void * v_addr, uint8_t * file_name)
+int32_t load_program(int pd, void * v_addr, pcb_t * pcb, uint8_t * file_name)
 {	
-	/* Get the size of the file */
 	uint8_t m_num[MNUM_SIZE];
 	dentry_t d;
 
 	if(-1 == read_dentry_by_name(file_name,&d)) return -1;
-	uint32_t size = read_size(d.inode_num);
-
-	/* Do not run more than 6 processes */
-	if(pd == MAX_PROCESSES){
-		term_write(0,(void*)err_proc,strlen((int8_t*)err_proc));
-		return -1;
-	}
-
-	/* Map the page in the appropriate page directory for this process */
-	ext_map_page(pd, p_addr, (uint8_t*)V_PAGE, USER_PDE_FLAGS);
 
 	/* If the file_name does not exist or is not a program file return failure */
 	if(d.file_type != STDOUT) return -1;
@@ -365,18 +543,58 @@ int32_t load_program(int pd, void * p_addr, void * v_addr, uint8_t * file_name)
 	/* Check if the file is an executable via its 4 bytes of magic numbers */
 	if(MG_1 != m_num[0] || MG_2 != m_num[1] || MG_3 != m_num[2] || MG_4 != m_num[3]) return -1;
 
-	/* Copy the program from the file system into new user frame */
-	if(-1 == read_data(d.inode_num,MNUM_OFFSET,(uint8_t*)v_addr,SIZEOF_LONG)) return -1;
+	/* Do not run more processes than there are task ids or memory for */
+	if(pd == -1 || -1 == new_page_directory(pd)){
+		term_write(0,(void*)err_proc,strlen((int8_t*)err_proc));
+		return -1;
+	}
+
+	/* Get the entry point straight from the file */
+	if(-1 == read_data(d.inode_num,MNUM_OFFSET,(uint8_t*)v_addr,SIZEOF_LONG)){
+		free_page_directory(pd);
+		return -1;
+	}
+	pcb->exe_inode = d.inode_num;
+	pcb->exe_size = read_size(d.inode_num);
+	pcb->exe_ro_end = text_end(d.inode_num, pcb->exe_size);
 
-	/* Map the kernel page into the process PD */
-	ext_map_page(pd, (void *)FOUR_MB, (void *)FOUR_MB, KERNEL_PDE_FLAGS);
 	set_page_directory(pd);
-	if(-1 == read_data(d.inode_num,0,(uint8_t*)V_ADDR,size)) return -1;
 
 	/* Return success */
 	return 0;
 }
 
+/* 
+ * text_end(uint32_t inode, uint32_t size)
+ *   DESCRIPTION: Finds how much of a program image, loaded flat at V_ADDR,
+ *				  is never written. That is every whole page of the image below
+ *				  the first writable segment in the program headers.
+ *   INPUTS: inode -- the inode of the program file
+ *			 size -- the number of bytes in the program file
+ *   OUTPUTS: none
+ *   RETURN VALUE: the end of the read-only pages, V_ADDR if there are none
+ *   SIDE EFFECTS: none
+ */
+uint32_t text_end(uint32_t inode, uint32_t size)
+{
+	uint32_t ph_off, end, i;
+	uint16_t ph_num = 0;
+	elf_phdr_t ph;
+
+	end = (V_ADDR + size) & (~LSB_12);
+	if(SIZEOF_LONG != read_data(inode,PHOFF_OFFSET,(uint8_t*)&ph_off,SIZEOF_LONG)) return V_ADDR;
+	if(PHNUM_SIZE != read_data(inode,PHNUM_OFFSET,(uint8_t*)&ph_num,PHNUM_SIZE)) return V_ADDR;
+
+	for(i = 0; i < ph_num; i++){
+		if(sizeof(elf_phdr_t) != read_data(inode,ph_off + i * sizeof(elf_phdr_t),(uint8_t*)&ph,sizeof(elf_phdr_t))) return V_ADDR;
+		if(ph.p_type != PT_LOAD || !(ph.p_flags & PF_W)) continue;
+		if(ph.p_vaddr < end) end = ph.p_vaddr & (~LSB_12);
+	}
+
+	if(end < V_ADDR) return V_ADDR;
+	return end;
+}
+
 /* 
  * sys_read(int32_t fd, void* buf, int32_t nbytes)
  *   DESCRIPTION: 
@@ -385,7 +603,7 @@ int32_t load_program(int pd, void * p_addr, void * v_addr, uint8_t * file_name)
  *			 nbytes - 
  *   OUTPUTS: none
  *   RETURN VALUE: always 0 for success
- *   SIDE EFFECTS: clears the file scope int_has_occurred flag
+ *   SIDE EFFECTS: whatever the read function of the file does
  */
 int32_t sys_read(int32_t fd, void* buf, int32_t nbytes)
 {
@@ -442,6 +660,11 @@ int32_t sys_open(const uint8_t* filename)
 	file->inode_num = dentry.inode_num;
 	file->file_pos = 0;
 	file->flags = 1;
+	file->rtc_div = 0;
+	file->rtc_next = 0;
+	file->ra_pos = 0;
+	file->ra_window = 0;
+	file->ra_end = 0;
 
 	/* Check for directory */
 	if(dentry.file_type == 0){
@@ -452,6 +675,7 @@ int32_t sys_open(const uint8_t* filename)
 	}
 	else if(dentry.file_type == STDOUT){
 		file->f_ops = &file_file_operations;
+		cache_file_size(file);
 	}
 
 	file->f_ops->open(filename);
@@ -462,20 +686,39 @@ int32_t sys_open(const uint8_t* filename)
 
 /* 
  * sys_close(int32_t fd)
- *   DESCRIPTION: Close a file
+ *   DESCRIPTION: Close a file. Stdin and stdout can only be closed while
+ *				  they are pipe ends, so a program can let go of its end and
+ *				  the other side sees end of file. The terminal stays open.
  *   INPUTS: fd - the file descriptor to close
  *   OUTPUTS: none
- *   RETURN VALUE: always 0 for success
+ *   RETURN VALUE: -1 for failure, 0 for success
  *   SIDE EFFECTS: none
  */
 int32_t sys_close(int32_t fd)
 {
+	file_t * file;
+
 	/* Make sure the file descriptor is valid */
-	if(fd > NUM_FILES-1 || fd < STDOUT) return -1;
+	if(fd > NUM_FILES-1 || fd < 0) return -1;
+	file = &get_pcb()->file_array[fd];
+	if(file->flags == 0) return -1;
+	if(fd < STDOUT && !is_pipe(file)) return -1;
+
+	return release_file(fd);
+}
 
-	/* Set the flag to closed */
+/* 
+ * release_file(int32_t fd)
+ *   DESCRIPTION: Closes any open file of the current task, stdin and stdout
+ *				  included, for halt and copyfd
+ *   INPUTS: fd - an open file descriptor
+ *   OUTPUTS: none
+ *   RETURN VALUE: always 0 for success
+ *   SIDE EFFECTS: Clears the file_t
+ */
+int32_t release_file(int32_t fd)
+{
 	pcb_t * pcb = get_pcb();
-	if(pcb->file_array[fd].flags == 0) return -1;
 
 	/* Call the correct close function */
 	pcb->file_array[fd].f_ops->close(fd);
@@ -485,6 +728,8 @@ int32_t sys_close(int32_t fd)
 	pcb->file_array[fd].f_ops = NULL;
 	pcb->file_array[fd].file_pos = 0;
 	pcb->file_array[fd].inode_num = 0;
+	pcb->file_array[fd].rtc_div = 0;
+	pcb->file_array[fd].rtc_next = 0;
 
 	/* Return success */
 	return 0;
@@ -520,21 +765,19 @@ int32_t sys_getargs(uint8_t* buf, int32_t nbytes)
  *   INPUTS: screen_start - pointer to pointer of returned v_addr
  *   OUTPUTS: none
  *   RETURN VALUE: -1 for failure, 0 on success
- *   SIDE EFFECTS: 
+ *   SIDE EFFECTS: Moves the screen of the caller's terminal back to the
+ *				   first rows of its text region, where the page starts
  */
 int32_t sys_vidmap(uint8_t** screen_start)
 {
 	/* Check if the screen_start is valid */
 	if((uint32_t)screen_start < V_PAGE || (uint32_t)screen_start >= V_PAGE+FOUR_MB) return -1;
 
-	/* If its the active term map to real vmem */
-	if(get_pcb()->term == get_active_term()){
-		map_page(get_pcb()->task_id,(void*) VIDEO, (void*) USER_VMEM, VIDEO_FLAGS);
-	}
-	/* If inactive term map to buffer */
-	else{
-		map_page(get_pcb()->task_id,(void*) VIDEO + (get_pcb()->term + 1) * FOUR_KB, (void*) USER_VMEM, VIDEO_FLAGS);
-	}
+	/* Map the start of the text region of its terminal, shown or not */
+	if(-1 == map_page(get_pcb()->task_id,(void*) VIDEO + get_pcb()->term * TEXT_BYTES, (void*) USER_VMEM, VIDEO_FLAGS)) return -1;
+
+	/* The program draws from the first row of the region, show that row first */
+	text_home();
 
 	/* Set screen_start to USER_VMEM */
 	*screen_start = (uint8_t*)USER_VMEM;
@@ -569,4 +812,401 @@ int32_t sys_sigreturn (void)
 	return 0;
 }
 
+/* 
+ * sys_getticks(void)
+ *   DESCRIPTION: Gets the number of scheduler ticks since boot, used by
+ *				  user programs to time themselves
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: the tick count, SCHEDULING_RATE ticks per second
+ *   SIDE EFFECTS: none
+ */
+int32_t sys_getticks (void)
+{
+	return get_ticks();
+}
+
+/* 
+ * sys_mmap(int32_t fd, void** addr)
+ *   DESCRIPTION: Maps the whole of an open file read-only into the caller's
+ *				  address space. The frames of the file's pages in the page
+ *				  cache are mapped, so nothing is copied once they are cached
+ *				  and the pages line up into one page aligned view of the file.
+ *				  Blocks of the image must never be mapped in place: writes
+ *				  only reach the cached pages and truncate hands freed blocks
+ *				  to other files, so a mapping of the image could go stale or
+ *				  show another file's data.
+ *   INPUTS: fd - an open regular file
+ *			 addr - gets the address the file starts at
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 for failure, the file size in bytes on success
+ *   SIDE EFFECTS: Maps pages between MMAP_START and MMAP_END
+ */
+int32_t sys_mmap(int32_t fd, void** addr)
+{
+	pcb_t * pcb = get_pcb();
+	uint32_t i, size, pages, start, frame;
+
+	if(fd > NUM_FILES-1 || fd < 0) return -1;
+	if(pcb->file_array[fd].flags == 0 || pcb->file_array[fd].f_ops != &file_file_operations) return -1;
+	if((uint32_t)addr < V_PAGE || (uint32_t)addr >= V_PAGE+FOUR_MB) return -1;
+
+	size = read_size(pcb->file_array[fd].inode_num);
+	pages = (size + FOUR_KB - 1) / FOUR_KB;
+	if(pages == 0){
+		*addr = NULL;
+		return 0;
+	}
+
+	/* Leave an unmapped page after the file so munmap can find its end */
+	start = find_user_range(pcb->task_id, MMAP_START, MMAP_END, pages + 1);
+	if(start == 0) return -1;
+
+	/* Map the file's pages in the page cache, shared with every other user of them */
+	for(i = 0; i < pages; i++){
+		frame = page_cache_get(pcb->file_array[fd].inode_num, i);
+		if(frame == 0 || -1 == map_page(pcb->task_id, (void *)frame, (void *)(start + i * FOUR_KB), USER_RO_PTE_FLAGS | PTE_MMAP | PTE_SHARED)){
+			if(frame != 0) page_cache_put(frame);
+			if(i > 0) sys_munmap((void *)start);
+			return -1;
+		}
+	}
+
+	*addr = (void *)start;
+	return size;
+}
+
+/* 
+ * sys_munmap(void* addr)
+ *   DESCRIPTION: Takes a file mapped by mmap back out of the caller's address space
+ *   INPUTS: addr - the address mmap returned
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 for failure, 0 on success
+ *   SIDE EFFECTS: Unmaps pages between MMAP_START and MMAP_END
+ */
+int32_t sys_munmap(void* addr)
+{
+	pcb_t * pcb = get_pcb();
+	uint32_t * pte;
+	uint32_t page = (uint32_t)addr;
+
+	if(page < MMAP_START || page >= MMAP_END || (page & LSB_12)) return -1;
+
+	/* The pages of one mapping run until the unmapped page after it */
+	for(; page < MMAP_END; page += FOUR_KB){
+		pte = get_pte(pcb->task_id, (void *)page);
+		if(pte == NULL || !(*pte & 0x1) || !(*pte & PTE_MMAP)) break;
+		unmap_user_page(pcb->task_id, (void *)page);
+	}
+
+	if(page == (uint32_t)addr) return -1;
+	return 0;
+}
+
+/* 
+ * sys_create(const uint8_t* filename)
+ *   DESCRIPTION: Creates an empty regular file, open it to write to it
+ *   INPUTS: filename - the name of the new file
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 for failure, 0 on success
+ *   SIDE EFFECTS: Adds a dentry to the filesystem
+ */
+int32_t sys_create(const uint8_t* filename)
+{
+	if(filename == NULL) return -1;
+	return fs_create(filename);
+}
+
+/* 
+ * sys_truncate(int32_t fd, uint32_t length)
+ *   DESCRIPTION: Cuts an open regular file short or pads it with zeros
+ *   INPUTS: fd - an open regular file
+ *			 length - the new length in bytes
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 for failure, 0 on success
+ *   SIDE EFFECTS: Frees or allocates data blocks
+ */
+int32_t sys_truncate(int32_t fd, uint32_t length)
+{
+	pcb_t * pcb = get_pcb();
+
+	if(fd > NUM_FILES-1 || fd < 0) return -1;
+	if(pcb->file_array[fd].flags == 0 || pcb->file_array[fd].f_ops != &file_file_operations) return -1;
+	return fs_truncate(pcb->file_array[fd].inode_num, length);
+}
+
+/* 
+ * sys_sync(void)
+ *   DESCRIPTION: Writes every file page changed since the last sync back to
+ *				  the filesystem image
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: the number of pages written back
+ *   SIDE EFFECTS: Writes the filesystem image
+ */
+int32_t sys_sync(void)
+{
+	return page_cache_sync();
+}
+
+/* 
+ * sys_cachestat(uint32_t* stats)
+ *   DESCRIPTION: Copies the page cache counters out for benchmarks
+ *   INPUTS: stats - gets CACHE_STAT_WORDS words, the hits, the misses and
+ *					 the number of pages in memory
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 for failure, 0 on success
+ *   SIDE EFFECTS: none
+ */
+int32_t sys_cachestat(uint32_t* stats)
+{
+	if((uint32_t)stats < V_PAGE || (uint32_t)stats > V_PAGE+FOUR_MB-CACHE_STAT_WORDS*SIZEOF_LONG) return -1;
+	page_cache_stats(stats);
+	return 0;
+}
+
+/* 
+ * sys_getdents(int32_t fd, void* buf, int32_t nbytes)
+ *   DESCRIPTION: Reads as many directory entries as fit in buf in one call,
+ *				  each one a dirent_t with the name, type, inode and size
+ *   INPUTS: fd - an open directory
+ *			 buf - gets the entries
+ *			 nbytes - the size of buf
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 for failure, 0 after the last entry, the number of
+ *				   bytes filled otherwise
+ *   SIDE EFFECTS: Moves the directory's position past the entries read
+ */
+int32_t sys_getdents(int32_t fd, void* buf, int32_t nbytes)
+{
+	pcb_t * pcb = get_pcb();
+
+	if(fd > NUM_FILES-1 || fd < 0) return -1;
+	if(pcb->file_array[fd].flags == 0 || pcb->file_array[fd].f_ops != &dir_file_operations) return -1;
+	if((uint32_t)buf < V_PAGE || nbytes < 0 || (uint32_t)buf + nbytes > V_PAGE+FOUR_MB) return -1;
+	return read_dirents(fd, (dirent_t *)buf, nbytes);
+}
+
+/* 
+ * sys_stat(const uint8_t* filename, void* buf)
+ *   DESCRIPTION: Looks up the type, inode and size of a file by name
+ *				  without opening it
+ *   INPUTS: filename - the name of the file
+ *			 buf - gets a stat_t
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 for failure, 0 on success
+ *   SIDE EFFECTS: none
+ */
+int32_t sys_stat(const uint8_t* filename, void* buf)
+{
+	dentry_t dentry;
+	stat_t * st = (stat_t *)buf;
+
+	if(filename == NULL || (uint32_t)buf < V_PAGE || (uint32_t)buf > V_PAGE+FOUR_MB-sizeof(stat_t)) return -1;
+	if(-1 == read_dentry_by_name(filename, &dentry)) return -1;
+
+	st->file_type = dentry.file_type;
+	st->inode_num = dentry.inode_num;
+	st->file_size = (dentry.file_type == STDOUT) ? read_size(dentry.inode_num) : 0;
+	return 0;
+}
+
+/* 
+ * sys_fstat(int32_t fd, void* buf)
+ *   DESCRIPTION: Gets the type, inode and size of an open file, the size of
+ *				  a regular file comes from its file_t. A pipe end gives
+ *				  PIPE_TYPE, its pipe number and size 0.
+ *   INPUTS: fd - an open file, not the terminal
+ *			 buf - gets a stat_t
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 for failure, 0 on success
+ *   SIDE EFFECTS: none
+ */
+int32_t sys_fstat(int32_t fd, void* buf)
+{
+	pcb_t * pcb = get_pcb();
+	file_t * file;
+	stat_t * st = (stat_t *)buf;
+
+	if(fd > NUM_FILES-1 || fd < 0 || pcb->file_array[fd].flags == 0) return -1;
+	if((uint32_t)buf < V_PAGE || (uint32_t)buf > V_PAGE+FOUR_MB-sizeof(stat_t)) return -1;
+	file = &(pcb->file_array[fd]);
 
+	if(file->f_ops == &file_file_operations) st->file_type = STDOUT;
+	else if(file->f_ops == &dir_file_operations) st->file_type = 1;
+	else if(file->f_ops == &rtc_file_operations) st->file_type = 0;
+	else if(is_pipe(file)) st->file_type = PIPE_TYPE;
+	else return -1;
+
+	st->inode_num = file->inode_num;
+	st->file_size = (st->file_type == STDOUT) ? file_size(file) : 0;
+	return 0;
+}
+
+/* 
+ * sys_ring_setup(void** addr)
+ *   DESCRIPTION: Maps an empty submission and completion ring into the
+ *				  caller, see ring.h for its layout
+ *   INPUTS: addr - gets the address of the ring
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 for failure, 0 on success
+ *   SIDE EFFECTS: Maps the page at RING_ADDR
+ */
+int32_t sys_ring_setup(void** addr)
+{
+	pcb_t * pcb = get_pcb();
+
+	if((uint32_t)addr < V_PAGE || (uint32_t)addr > V_PAGE+FOUR_MB-sizeof(void *)) return -1;
+	if(-1 == ring_setup(pcb)) return -1;
+	pcb->ring = 1;
+	*addr = (void *)RING_ADDR;
+	return 0;
+}
+
+/* 
+ * sys_ring_enter(void)
+ *   DESCRIPTION: Runs the operations submitted to the caller's ring
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 without a ring, the number of operations run otherwise
+ *   SIDE EFFECTS: Posts a completion for every operation run
+ */
+int32_t sys_ring_enter(void)
+{
+	pcb_t * pcb = get_pcb();
+
+	if(!pcb->ring) return -1;
+	return ring_enter(pcb);
+}
+
+/* 
+ * sys_readv(int32_t fd, const iovec_t* iov, int32_t iovcnt)
+ *   DESCRIPTION: Reads into several buffers in one call, through the
+ *				  file's readv or one read per buffer
+ *   INPUTS: fd - the file descriptor
+ *			 iov - the buffers
+ *			 iovcnt - how many there are, at most MAX_IOV
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 for failure, the number of bytes read otherwise
+ *   SIDE EFFECTS: Moves the file position
+ */
+int32_t sys_readv(int32_t fd, const iovec_t* iov, int32_t iovcnt)
+{
+	pcb_t * pcb = get_pcb();
+	int32_t i, count, total = 0;
+
+	if(fd > NUM_FILES-1 || fd < 0 || fd == 1 || pcb->file_array[fd].flags == 0) return -1;
+	if(iovcnt < 0 || iovcnt > MAX_IOV) return -1;
+	if((uint32_t)iov < V_PAGE || (uint32_t)iov > V_PAGE+FOUR_MB-iovcnt*sizeof(iovec_t)) return -1;
+	if(pcb->file_array[fd].f_ops->readv != NULL) return pcb->file_array[fd].f_ops->readv(fd, iov, iovcnt);
+
+	for(i = 0; i < iovcnt; i++){
+		count = pcb->file_array[fd].f_ops->read(fd, iov[i].base, iov[i].len);
+		if(count == -1) return (total == 0) ? -1 : total;
+		total += count;
+		if(count < iov[i].len) break;
+	}
+	return total;
+}
+
+/* 
+ * sys_writev(int32_t fd, const iovec_t* iov, int32_t iovcnt)
+ *   DESCRIPTION: Writes several buffers in one call, through the file's
+ *				  writev or one write per buffer
+ *   INPUTS: fd - the file descriptor
+ *			 iov - the buffers
+ *			 iovcnt - how many there are, at most MAX_IOV
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 for failure, the number of bytes written otherwise
+ *   SIDE EFFECTS: Moves the file position or the cursor
+ */
+int32_t sys_writev(int32_t fd, const iovec_t* iov, int32_t iovcnt)
+{
+	pcb_t * pcb = get_pcb();
+	int32_t i, count, total = 0;
+
+	if(fd > NUM_FILES-1 || fd < 1 || pcb->file_array[fd].flags == 0) return -1;
+	if(iovcnt < 0 || iovcnt > MAX_IOV) return -1;
+	if((uint32_t)iov < V_PAGE || (uint32_t)iov > V_PAGE+FOUR_MB-iovcnt*sizeof(iovec_t)) return -1;
+	if(pcb->file_array[fd].f_ops->writev != NULL) return pcb->file_array[fd].f_ops->writev(fd, iov, iovcnt);
+
+	for(i = 0; i < iovcnt; i++){
+		count = pcb->file_array[fd].f_ops->write(fd, iov[i].base, iov[i].len);
+		if(count == -1) return (total == 0) ? -1 : total;
+		total += count;
+		if(count < iov[i].len) break;
+	}
+	return total;
+}
+
+/* 
+ * sys_pipe(int32_t* fds)
+ *   DESCRIPTION: Makes a pipe and opens both of its ends in the caller
+ *   INPUTS: fds - gets the read end in fds[0] and the write end in fds[1]
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 for failure, 0 on success
+ *   SIDE EFFECTS: Changes the file_array
+ */
+int32_t sys_pipe(int32_t* fds)
+{
+	pcb_t * pcb = get_pcb();
+	int32_t read_fd, write_fd;
+
+	if((uint32_t)fds < V_PAGE || (uint32_t)fds > V_PAGE+FOUR_MB-2*sizeof(int32_t)) return -1;
+
+	/* Two free descriptors, lowest first */
+	for(read_fd = 0; read_fd < NUM_FILES; read_fd++){
+		if(pcb->file_array[read_fd].flags == 0) break;
+	}
+	for(write_fd = read_fd + 1; write_fd < NUM_FILES; write_fd++){
+		if(pcb->file_array[write_fd].flags == 0) break;
+	}
+	if(write_fd >= NUM_FILES) return -1;
+
+	if(-1 == pipe_create(&pcb->file_array[read_fd], &pcb->file_array[write_fd])) return -1;
+	fds[0] = read_fd;
+	fds[1] = write_fd;
+	return 0;
+}
+
+/* 
+ * sys_copyfd(int32_t old_fd, int32_t new_fd)
+ *   DESCRIPTION: Makes new_fd a copy of old_fd, closing whatever new_fd had
+ *				  open first. Unlike dup2 the two do not share a position:
+ *				  the file_t is copied, so reads through one do not move the
+ *				  other. Pipe ends and the terminal have no position, so
+ *				  this is still how a shell points stdin or stdout at a pipe.
+ *   INPUTS: old_fd - an open file descriptor
+ *			 new_fd - the descriptor to make a copy in
+ *   OUTPUTS: none
+ *   RETURN VALUE: -1 for failure, new_fd on success
+ *   SIDE EFFECTS: Changes the file_array
+ */
+int32_t sys_copyfd(int32_t old_fd, int32_t new_fd)
+{
+	pcb_t * pcb = get_pcb();
+
+	if(old_fd > NUM_FILES-1 || old_fd < 0 || new_fd > NUM_FILES-1 || new_fd < 0) return -1;
+	if(pcb->file_array[old_fd].flags == 0) return -1;
+	if(old_fd == new_fd) return new_fd;
+
+	if(pcb->file_array[new_fd].flags == 1) release_file(new_fd);
+	pcb->file_array[new_fd] = pcb->file_array[old_fd];
+	pipe_dup(&pcb->file_array[new_fd]);
+	return new_fd;
+}
+
+/* 
+ * sys_has_sysenter(void)
+ *   DESCRIPTION: Tells a program whether it may enter the kernel through
+ *				  SYSENTER, which faults on a processor init_sysenter found
+ *				  without it
+ *   INPUTS: none
+ *   OUTPUTS: none
+ *   RETURN VALUE: 1 if SYSENTER works, 0 if only int $0x80 does
+ *   SIDE EFFECTS: none
+ */
+int32_t sys_has_sysenter(void)
+{
+	return sysenter_ok;
+}
@@ -16,6 +16,7 @@
 #include "terminal.h"
 #include "x86_desc.h"
 #include "keyboard.h"
+#include "asm_syscall.h"
 
 #define V_PAGE 0x08000000 
 #define V_ADDR 0x08048000 //Where the program image is set to execute
@@ -25,7 +26,12 @@
 #define MG_4 0x46
 #define MNUM_SIZE 4
 #define MNUM_OFFSET 24
-#define NO_PROCESSES 0xFE
+#define PHOFF_OFFSET 28			/* ELF header field with the file offset of the program headers */
+#define PHNUM_OFFSET 44			/* ELF header field with the number of program headers */
+#define PHNUM_SIZE 2
+#define PT_LOAD 1
+#define PF_W 0x2
+#define TASK_MAP_SIZE (MAX_PROCESSES / BITS_PER_LONG)
 #define EIGHT_MB 0x800000
 #define EIGHT_KB 0x2000
 #define NUM_FILES 8
@@ -33,20 +39,51 @@
 #define STDOUT 2
 #define VIDEO_FLAGS 0x7 /* User, read/write, present */
 #define USER_VMEM 0x8400000
+#define MAX_IOV 16 /* Most buffers one readv or writev takes */
+#define SYSCALL_FRAME_SIZE 13 /* Dwords the processor and syscall_handler push for int $0x80 */
+#define SYSENTER_CS_MSR 0x174	/* Kernel code segment SYSENTER loads, its stack segment is the next one */
+#define SYSENTER_ESP_MSR 0x175	/* Kernel stack pointer SYSENTER loads */
+#define SYSENTER_EIP_MSR 0x176	/* Where SYSENTER jumps to */
+#define CPUID_FEATURES 1		/* CPUID leaf with the feature flags */
+#define CPUID_SEP 0x800			/* EDX feature flag for SYSENTER/SYSEXIT */
 
-extern uint8_t tasks_bitmap;
-
+void init_sysenter(void);
+void set_kernel_stack(uint32_t esp0);
 int32_t sys_halt(uint8_t status);
 int32_t sys_execute(const uint8_t* command);
+int32_t spawn_shell (void);
 int32_t sys_fork (void);
-int32_t load_program(int pd, void * p_addr, void * v_addr, uint8_t * file_name);
+int32_t load_program(int pd, void * v_addr, pcb_t * pcb, uint8_t * file_name);
+uint32_t text_end(uint32_t inode, uint32_t size);
+int32_t find_task_id(void);
+void claim_task_id(int pd);
+void release_task_id(int pd);
+int32_t task_running(int pd);
 int32_t sys_read(int32_t fd, void* buf, int32_t nbytes);
 int32_t sys_write(int32_t fd, const void* buf, int32_t nbytes);
 int32_t sys_open(const uint8_t* filename);
 int32_t sys_close(int32_t fd);
+int32_t release_file(int32_t fd);
 int32_t sys_getargs(uint8_t* buf, int32_t nbytes);
 int32_t sys_vidmap (uint8_t** screen_start);
 int32_t sys_set_handler(int32_t signum, void* handler_address);
 int32_t sys_sigreturn (void);
+int32_t sys_getticks (void);
+int32_t sys_mmap (int32_t fd, void** addr);
+int32_t sys_munmap (void* addr);
+int32_t sys_create (const uint8_t* filename);
+int32_t sys_truncate (int32_t fd, uint32_t length);
+int32_t sys_sync (void);
+int32_t sys_cachestat (uint32_t* stats);
+int32_t sys_getdents (int32_t fd, void* buf, int32_t nbytes);
+int32_t sys_stat (const uint8_t* filename, void* buf);
+int32_t sys_fstat (int32_t fd, void* buf);
+int32_t sys_ring_setup (void** addr);
+int32_t sys_ring_enter (void);
+int32_t sys_readv (int32_t fd, const iovec_t* iov, int32_t iovcnt);
+int32_t sys_writev (int32_t fd, const iovec_t* iov, int32_t iovcnt);
+int32_t sys_pipe (int32_t* fds);
+int32_t sys_copyfd (int32_t old_fd, int32_t new_fd);
+int32_t sys_has_sysenter (void);
 
 #endif /* _SYSCALL_H */
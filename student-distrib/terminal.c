@@ -15,7 +15,8 @@ fops_t term_file_operations = {
 	.read = key_read,
 	.write = term_write,
 	.open = term_open,
-	.close = term_close
+	.close = term_close,
+	.writev = term_writev
 };
 
 /* 
@@ -47,6 +48,89 @@ int32_t term_read(int32_t fd, void* buf, int32_t nbytes)
 	return 0;
 }
 
+/* 
+ * put_run(uint16_t* dst, const char* src, int32_t len)
+ *   DESCRIPTION: copies characters into video memory as character and
+ *				  attribute words, two per dword store
+ *   INPUTS: dst - where the first character goes
+ *			 src - the characters
+ *			 len - how many there are
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: modifies video memory
+ */
+static void put_run(uint16_t* dst, const char* src, int32_t len)
+{
+	int32_t i = 0;
+
+	/* One word first if the run does not start on a dword */
+	if(((uint32_t)dst & 0x2) && len > 0){
+		dst[0] = (uint8_t)src[0] | (ATTRIB << 8);
+		i = 1;
+	}
+	for(; i + 1 < len; i += 2){
+		*(uint32_t *)(dst + i) = (uint8_t)src[i] | (ATTRIB << 8) | ((uint8_t)src[i + 1] << 16) | (ATTRIB << 24);
+	}
+	if(i < len) dst[i] = (uint8_t)src[i] | (ATTRIB << 8);
+}
+
+/* 
+ * term_put(const char* addr, int32_t nbytes, uint32_t* x, uint32_t* y)
+ *   DESCRIPTION: puts characters on the screen from a cursor position. A
+ *				  first pass finds where the cursor ends up so the screen
+ *				  scrolls once for the whole buffer, then each run of
+ *				  characters up to a newline or the end of a line is copied
+ *				  in one go. Rows that scroll off before the end go straight
+ *				  to the scrollback.
+ *   INPUTS: addr - the characters
+ *			 nbytes - how many there are
+ *			 x, y - the cursor, moved past what is written
+ *   OUTPUTS: none
+ *   RETURN VALUE: none
+ *   SIDE EFFECTS: modifies video memory, may scroll
+ */
+static void term_put(const char* addr, int32_t nbytes, uint32_t* x, uint32_t* y)
+{
+	int32_t i, start, row, scroll;
+	uint32_t col = *x, end_y = *y, region = text_region();
+	uint16_t * video, * line;
+
+	/* Wrap at a newline or before a character past the end of the line */
+	for(i = 0; i < nbytes; i++){
+		if((addr[i] == '\n') || (col > NUM_COLS - 1)){
+			col = 0;
+			end_y++;
+		}
+		if(addr[i] != '\n') col++;
+	}
+
+	/* If it runs off the bottom, scroll the whole screen up once */
+	scroll = (end_y > NUM_ROWS - 1) ? end_y - (NUM_ROWS - 1) : 0;
+	vert_scroll_lines(scroll);
+	video = (uint16_t *)text_base();
+
+	/* Same walk again, rows above the top of the screen are gone already */
+	row = (int32_t)*y - scroll;
+	col = *x;
+	for(i = 0; i < nbytes; ){
+		if((addr[i] == '\n') || (col > NUM_COLS - 1)){
+			col = 0;
+			row++;
+		}
+		if(addr[i] == '\n'){
+			i++;
+			continue;
+		}
+		for(start = i; i < nbytes && addr[i] != '\n' && col + (i - start) < NUM_COLS; i++);
+		if(row >= 0) put_run(video + row * NUM_COLS + col, addr + start, i - start);
+		else if(NULL != (line = (uint16_t *)scrollback_line(region, -row))) put_run(line + col, addr + start, i - start);
+		col += i - start;
+	}
+
+	*x = col;
+	*y = end_y - scroll;
+}
+
 /* 
  * term_write(int32_t fd, void* buf, int32_t nbytes)
  *   DESCRIPTION: takes buffer and outputs nbytes to screen
@@ -59,44 +143,47 @@ int32_t term_read(int32_t fd, void* buf, int32_t nbytes)
  */
 int32_t term_write(int32_t fd, const void* buf, int32_t nbytes)
 {
-	/* Loop counter */
-	uint32_t i, x = screen_x, y = screen_y;
-
+	uint32_t x = screen_x, y = screen_y;
 
 	/* Null ptr check */
 	if(buf == NULL || nbytes < 0) return -1;
 
-	/* Cast buf to a char ptr */
-	char * addr = (char *)buf;
+	term_put((const char *)buf, nbytes, &x, &y);
 
+	screen_y = y;
+	screen_x = x;
+	
+	return 0;
+}
 
-	/* Loops through the given buffer and writes to the screen */
-	for(i = 0; i < nbytes; i++){
-		/* Check to see if need to go to a new line */
-		if((addr[i] == '\n') || (x > NUM_COLS - 1)){
-			x = 0;
-	    	y++;
-		}
+/* 
+ * term_writev(int32_t fd, const iovec_t* iov, int32_t iovcnt)
+ *   DESCRIPTION: outputs several buffers to the screen one after another,
+ *				  picking up the cursor once for all of them
+ *   INPUTS: fd - file descriptor
+ *			 iov - the buffers
+ *			 iovcnt - how many there are
+ *   OUTPUTS: none
+ *   RETURN VALUE: the number of bytes written, -1 if a buffer is bad
+ *   SIDE EFFECTS: modifies video memory
+ */
+int32_t term_writev(int32_t fd, const iovec_t* iov, int32_t iovcnt)
+{
+	uint32_t x = screen_x, y = screen_y;
+	int32_t i, count = 0;
 
-		/* If at the bottom, scroll the whole screen up */
-	    if(y > NUM_ROWS - 1){
-	    	y = NUM_ROWS - 1;
-	    	x = 0;
-	    	vert_scroll();
-	    }
-
-		/* Write to video memory */
-		if(addr[i] != '\n'){
-			*(uint8_t *)(VIDEO + ((NUM_COLS * y + x) << 1)) = addr[i];
-	    	*(uint8_t *)(VIDEO + ((NUM_COLS * y + x) << 1) + 1) = ATTRIB;
-	    	x++;
-	    }
+	for(i = 0; i < iovcnt; i++){
+		if(iov[i].base == NULL || iov[i].len < 0) return -1;
+	}
+	for(i = 0; i < iovcnt; i++){
+		term_put((const char *)iov[i].base, iov[i].len, &x, &y);
+		count += iov[i].len;
 	}
 
 	screen_y = y;
 	screen_x = x;
-	
-	return 0;
+
+	return count;
 }
 
 /* 
@@ -146,11 +233,11 @@ void term_switch(int new_term)
 	pcb_t * old_pcb = get_pcb();
 
 	/* Print error message if no new tasks can be started, but the user is trying to open a new terminal */
-	if(tasks_bitmap == 0x80 && (((new_term == 1) && TERM1_FLAG) || ((new_term == 2) && TERM2_FLAG))){
+	if(find_task_id() == -1 && (((new_term == 1) && TERM1_FLAG) || ((new_term == 2) && TERM2_FLAG))){
 			
 		for(i = 1; i < MAX_PROCESSES; i++){
 			pcb = (pcb_t *)(EIGHT_MB - i*EIGHT_KB);
-			if(pcb->term == active_term && pcb->child == NULL) break;
+			if(task_running(i) && pcb->term == active_term && pcb->child == NULL) break;
 		}
 
 		/* Swipswap screenx/y values if curr process in inactive term */
@@ -191,11 +278,9 @@ void term_switch(int new_term)
 
 	/* If entering a new terminal without a shell....start dat shell */
 	if(new_term == 1 && TERM1_FLAG){
-		sys_fork();
-		TERM1_FLAG = 0;
+		if(0 == spawn_shell()) TERM1_FLAG = 0;
 	}
 	if(new_term == 2 && TERM2_FLAG){
-		sys_fork();
-		TERM2_FLAG = 0;
+		if(0 == spawn_shell()) TERM2_FLAG = 0;
 	}
 }
@@ -25,6 +25,7 @@ extern fops_t term_file_operations;
 void term_init(void);
 int32_t term_read(int32_t fd, void* buf, int32_t nbytes);
 int32_t term_write(int32_t fd, const void* buf, int32_t nbytes);
+int32_t term_writev(int32_t fd, const iovec_t* iov, int32_t iovcnt);
 int32_t term_open(const uint8_t* filename);
 int32_t term_close(int32_t fd);
 void term_switch(int new_term);
@@ -11,7 +11,7 @@
 #define ARG_BYTES 1024
 #define NAME_SIZE 32
 #define FILE_ARRAY_SIZE 8
-#define MAX_PROCESSES 7
+#define MAX_PROCESSES 64
 #define ATTRIB 0x02
 #define REG_SIZE 14
 #define SIZEOF_LONG 4
@@ -40,28 +40,103 @@ typedef struct dentry {
 	int32_t inode_num;
 } dentry_t;
 
-/* The RWOC functions for a specific file */
+/* 
+ * One directory entry as getdents hands it to user programs
+ * file_name -- the name of the file, not terminated if it fills the field
+ * file_type -- 0 for RTC, 1 for directory, 2 for normal file
+ * inode_num -- the inode number of the file
+ * file_size -- the length of a normal file in bytes, 0 for the others
+ */
+typedef struct dirent {
+	char file_name[NAME_SIZE];
+	int32_t file_type;
+	int32_t inode_num;
+	uint32_t file_size;
+} dirent_t;
+
+/* 
+ * What stat and fstat report about a file
+ * file_type -- 0 for RTC, 1 for directory, 2 for normal file
+ * inode_num -- the inode number of the file
+ * file_size -- the length of a normal file in bytes, 0 for the others
+ */
+typedef struct stat {
+	int32_t file_type;
+	int32_t inode_num;
+	uint32_t file_size;
+} stat_t;
+
+/* 
+ * One buffer of a readv or writev
+ * base -- start of the buffer
+ * len -- its length in bytes
+ */
+typedef struct iovec {
+	void * base;
+	int32_t len;
+} iovec_t;
+
+/* The RWOC functions for a specific file, readv and writev may be NULL
+   and then each buffer takes its own read or write */
 typedef struct fops {
 	int32_t (*open)(const uint8_t * filename);
 	int32_t (*read)(int32_t fd, void* buf, int32_t nbytes);
 	int32_t (*write)(int32_t fd, const void* buf, int32_t nbytes);
 	int32_t (*close)(int32_t fd);
+	int32_t (*readv)(int32_t fd, const iovec_t* iov, int32_t iovcnt);
+	int32_t (*writev)(int32_t fd, const iovec_t* iov, int32_t iovcnt);
 } fops_t;
 
 /*
  * Information about one file
  * f_ops -- RWOC functions specific to that file
- * inode_num -- the inode number of that file
+ * inode_num -- the inode number of that file, the pipe number for a pipe end
  * file_pos -- the number of bytes of the file that have already been read
  * flags -- 1 if the file is in use, 0 if not
+ * rtc_div -- RTC files only, hardware RTC ticks per virtual tick (0 for default)
+ * rtc_next -- RTC files only, the hardware RTC tick of the next virtual tick
+ * ra_pos -- regular files only, where the next read starts if reading is sequential
+ * ra_window -- regular files only, pages read ahead of a sequential read (0 before one)
+ * ra_end -- regular files only, the first page not yet read ahead
+ * file_size -- regular files only, the length of the file when size_gen was read
+ * size_gen -- regular files only, the filesystem's size generation file_size is from
  */
 typedef struct file {
 	fops_t * f_ops;
 	uint32_t inode_num;
 	uint32_t file_pos;
 	uint32_t flags;
+	uint32_t rtc_div;
+	uint32_t rtc_next;
+	uint32_t ra_pos;
+	uint32_t ra_window;
+	uint32_t ra_end;
+	uint32_t file_size;
+	uint32_t size_gen;
 } file_t;
 
+/*
+ * A program header from an executable, describes one segment
+ * p_type -- 1 for a segment that is loaded
+ * p_offset -- where the segment starts in the file
+ * p_vaddr -- where the segment starts in memory
+ * p_paddr -- unused
+ * p_filesz -- the number of bytes of the segment in the file
+ * p_memsz -- the number of bytes of the segment in memory
+ * p_flags -- bit 1 is set if the segment is writable
+ * p_align -- alignment of the segment
+ */
+typedef struct elf_phdr {
+	uint32_t p_type;
+	uint32_t p_offset;
+	uint32_t p_vaddr;
+	uint32_t p_paddr;
+	uint32_t p_filesz;
+	uint32_t p_memsz;
+	uint32_t p_flags;
+	uint32_t p_align;
+} elf_phdr_t;
+
 typedef struct pcb pcb_t;
 
 /*
@@ -75,6 +150,17 @@ typedef struct pcb pcb_t;
  * arg -- arguments to the user program
  * arg_len -- length of arguments to the user program
  * term -- the terminal in which this process in running
+ * forked -- 1 if made by fork, nobody waits for it and it does not restart when it halts
+ * rq_next -- the next task in the same run queue level
+ * rq_prev -- the previous task in the same run queue level
+ * priority -- the run queue level of this task, 0 is the highest
+ * state -- TASK_RUNNABLE while on the run queue, TASK_BLOCKED otherwise
+ * wq_next -- the next task sleeping on the same wait queue
+ * wake_tick -- the tick a task sleeping on a queue kept in tick order waits for
+ * exe_inode -- the inode of the program image, user pages are filled from it on first touch
+ * exe_size -- the number of bytes in the program image
+ * exe_ro_end -- user pages from V_ADDR up to here are read-only text shared through the page cache
+ * ring -- 1 once ring_setup has given the task a ring at RING_ADDR
  */
 struct pcb {
 	file_t file_array[FILE_ARRAY_SIZE];
@@ -86,6 +172,17 @@ struct pcb {
 	uint8_t arg[ARG_BYTES];
 	int arg_len;
 	int term;
+	int forked;
+	pcb_t * rq_next;
+	pcb_t * rq_prev;
+	int priority;
+	int state;
+	pcb_t * wq_next;
+	uint32_t wake_tick;
+	uint32_t exe_inode;
+	uint32_t exe_size;
+	uint32_t exe_ro_end;
+	uint32_t ring;
 };
 
 #endif /* ASM */
@@ -0,0 +1,63 @@
+#include <stdint.h>
+
+#include "ece391support.h"
+#include "ece391syscall.h"
+
+#define RUN_SECS 5
+#define NS_PER_SEC 1000000000
+
+/*
+ * Runs getticks for RUN_SECS seconds through int $0x80, returns the
+ * number of calls made. getticks does almost nothing in the kernel, so
+ * this is the cost of getting in and out. The call is its own clock, so
+ * this does not go through ece391_run_for, which would add a second call
+ * per loop.
+ */
+static uint32_t int80_loop ()
+{
+    uint32_t end, calls = 0;
+
+    end = ece391_tick_align() + RUN_SECS * ECE391_TICKS_PER_SEC;
+
+    while (ece391_getticks() < end)
+        calls++;
+    return calls;
+}
+
+/* The same loop through SYSENTER */
+static uint32_t sysenter_loop ()
+{
+    uint32_t end, calls = 0;
+
+    end = ece391_tick_align() + RUN_SECS * ECE391_TICKS_PER_SEC;
+
+    while (ece391_fast_getticks() < end)
+        calls++;
+    return calls;
+}
+
+/* Prints the results of one loop */
+static void report (const uint8_t* name, uint32_t calls)
+{
+    ece391_fdputs(1, name);
+    ece391_put_num((uint8_t*)" calls per second: ", calls / RUN_SECS);
+    ece391_fdputs(1, name);
+    ece391_put_num((uint8_t*)" nanoseconds per call: ", NS_PER_SEC / (calls / RUN_SECS + 1));
+}
+
+/*
+ * System call latency benchmark. Makes the same null call in a tight loop
+ * through int $0x80 and then through SYSENTER, and reports both. SYSENTER
+ * faults on a processor without it, so that half is skipped there.
+ */
+int main ()
+{
+    ece391_put_num((uint8_t*)"Seconds each for int $0x80 and SYSENTER: ", RUN_SECS);
+    report((uint8_t*)"int $0x80", int80_loop());
+    if (ece391_has_sysenter() != 1) {
+        ece391_fdputs(1, (uint8_t*)"sysenter not supported, skipped\n");
+        return 0;
+    }
+    report((uint8_t*)"sysenter", sysenter_loop());
+    return 0;
+}
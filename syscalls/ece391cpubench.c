@@ -0,0 +1,36 @@
+#include <stdint.h>
+
+#include "ece391support.h"
+#include "ece391syscall.h"
+
+#define RUN_SECS 10
+
+/* One unit of busy work */
+static int32_t work_unit ()
+{
+    volatile uint32_t sink = 0;
+    uint32_t i;
+
+    for (i = 0; i < 10000; i++)
+        sink += i;
+    return 0;
+}
+
+/*
+ * CPU throughput benchmark. Counts how many units of busy work this task
+ * gets through in RUN_SECS seconds of wall time. Run it in terminal 2 while
+ * the shell in terminal 1 sits at its prompt; every slice the idle shell
+ * takes shows up as a lower count here.
+ */
+int main ()
+{
+    int32_t work;
+
+    ece391_put_num((uint8_t*)"Seconds of busy loop: ", RUN_SECS);
+    work = ece391_run_for(RUN_SECS, work_unit, 0);
+
+    ece391_put_num((uint8_t*)"work units: ", work);
+    ece391_put_num((uint8_t*)"work units per second: ", work / RUN_SECS);
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include <stdint.h>
+
+#include "ece391support.h"
+#include "ece391syscall.h"
+
+#define BUFSIZE 1024
+#define RUN_SECS 10
+#define CACHE_STAT_WORDS 3
+
+static uint8_t command[BUFSIZE];
+
+/* One execute/halt round trip */
+static int32_t exec_once ()
+{
+    return ece391_execute (command);
+}
+
+/*
+ * Exec latency benchmark. Runs the program named by its argument (with no
+ * arguments of its own) over and over for RUN_SECS seconds and reports the
+ * average time per execute/halt round trip, e.g. "execbench testprint" or
+ * "execbench cat". The program has to exit by itself, so shell only works
+ * by typing exit at each prompt and fish cannot be timed this way. Also
+ * reports how many page cache lookups the runs hit and missed.
+ */
+int main ()
+{
+    int32_t runs;
+    uint32_t ticks;
+    uint32_t before[CACHE_STAT_WORDS], after[CACHE_STAT_WORDS];
+
+    if (0 != ece391_getargs (command, BUFSIZE) || '\0' == command[0]) {
+        ece391_fdputs (1, (uint8_t*)"usage: execbench <program>\n");
+        return 3;
+    }
+
+    ece391_cachestat (before);
+    if (0 >= (runs = ece391_run_for (RUN_SECS, exec_once, &ticks))) {
+        ece391_fdputs (1, (uint8_t*)"could not execute program\n");
+        return 2;
+    }
+    ece391_cachestat (after);
+
+    ece391_put_num ((uint8_t*)"execs: ", runs);
+    ece391_put_num ((uint8_t*)"microseconds per exec: ", ticks * (1000000 / ECE391_TICKS_PER_SEC) / runs);
+    ece391_put_num ((uint8_t*)"page cache hits: ", after[0] - before[0]);
+    ece391_put_num ((uint8_t*)"page cache misses: ", after[1] - before[1]);
+
+    return 0;
+}
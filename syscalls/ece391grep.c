@@ -6,17 +6,16 @@
 #define BUFSIZE 1024
 #define SBUFSIZE 33
 
+/* print the lines of fd that contain s, prefixed by fname unless it is 0 */
 int32_t
-do_one_file (const char* s, const char* fname) 
+do_one_fd (const char* s, int32_t fd, const char* fname) 
 {
-    int32_t fd, cnt, last, line_start, line_end, check, s_len;
+    int32_t cnt, last, line_start, line_end, check, s_len, first;
     uint8_t data[BUFSIZE+1];
+    ece391_iovec_t iov[4];
 
     s_len = ece391_strlen ((uint8_t*)s);
-    if (-1 == (fd = ece391_open ((uint8_t*)fname))) {
-        ece391_fdputs (1, (uint8_t*)"file open failed\n");
-        return -1;
-    }
+    first = (0 == fname) ? 2 : 0;
     last = 0;
     while (1) {
         cnt = ece391_read (fd, data + last, BUFSIZE - last);
@@ -30,7 +29,8 @@ do_one_file (const char* s, const char* fname)
 	    line_end = line_start;
 	    while (line_end < last && '\n' != data[line_end])
 		line_end++;
-	    if ('\n' != data[line_end] && 0 != cnt && line_start != 0) {
+	    /* a pipe can stop mid line, keep the piece unless the buffer is full */
+	    if (line_end == last && 0 != cnt && (line_start != 0 || last < BUFSIZE)) {
 		/* copy from line_start to last down to 0 and fix last */
 		data[line_end] = '\0';
 		ece391_strcpy (data, data + line_start);
@@ -42,10 +42,16 @@ do_one_file (const char* s, const char* fname)
 	    for (check = line_start; check < line_end; check++) {
 		if (s[0] == data[check] && 
 		    0 == ece391_strncmp ((uint8_t*)(data + check), (uint8_t*)s, s_len)) {
-		    ece391_fdputs (1, (uint8_t*)fname);
-		    ece391_fdputs (1, (uint8_t*)":");
-		    ece391_fdputs (1, data + line_start);
-		    ece391_fdputs (1, (uint8_t*)"\n");
+		    /* the whole match line in one call */
+		    iov[0].base = (void*)fname;
+		    iov[0].len = first ? 0 : ece391_strlen ((uint8_t*)fname);
+		    iov[1].base = ":";
+		    iov[1].len = 1;
+		    iov[2].base = data + line_start;
+		    iov[2].len = line_end - line_start;
+		    iov[3].base = "\n";
+		    iov[3].len = 1;
+		    ece391_writev (1, iov + first, 4 - first);
 		    break;
 		}
 	    }
@@ -58,6 +64,20 @@ do_one_file (const char* s, const char* fname)
 	if (0 == cnt)
 	    break;
     }
+    return 0;
+}
+
+int32_t
+do_one_file (const char* s, const char* fname) 
+{
+    int32_t fd;
+
+    if (-1 == (fd = ece391_open ((uint8_t*)fname))) {
+        ece391_fdputs (1, (uint8_t*)"file open failed\n");
+        return -1;
+    }
+    if (0 != do_one_fd (s, fd, fname))
+        return -1;
     if (-1 == ece391_close (fd)) {
         ece391_fdputs (1, (uint8_t*)"file close failed\n");
         return -1;
@@ -70,12 +90,17 @@ int main ()
     int32_t fd, cnt;
     uint8_t buf[SBUFSIZE];
     uint8_t search[BUFSIZE];
+    ece391_stat_t st;
 
     if (0 != ece391_getargs (search, BUFSIZE)) {
         ece391_fdputs (1, (uint8_t*)"could not read argument\n");
         return 3;
     }
 
+    /* at the end of a pipeline, search what the previous program writes */
+    if (0 == ece391_fstat (0, &st) && ECE391_PIPE_TYPE == st.type)
+        return (0 == do_one_fd ((char*)search, 0, 0)) ? 0 : 3;
+
     if (-1 == (fd = ece391_open ((uint8_t*)"."))) {
         ece391_fdputs (1, (uint8_t*)"directory open failed\n");
 	return 2;
@@ -3,27 +3,40 @@
 #include "ece391support.h"
 #include "ece391syscall.h"
 
-#define SBUFSIZE 33
+#define NAMESIZE 32
+#define MAXENTS 63
 
+/*
+ * Lists the directory one name per line, all of it comes back from one
+ * getdents call and goes out in one write.
+ */
 int main ()
 {
-    int32_t fd, cnt;
-    uint8_t buf[SBUFSIZE];
+    int32_t fd, cnt, i, j, len;
+    ece391_dirent_t ents[MAXENTS];
+    uint8_t out[MAXENTS * (NAMESIZE + 1)];
 
     if (-1 == (fd = ece391_open ((uint8_t*)"."))) {
         ece391_fdputs (1, (uint8_t*)"directory open failed\n");
         return 2;
     }
 
-    while (0 != (cnt = ece391_read (fd, buf, SBUFSIZE-1))) {
+    len = 0;
+    while (0 != (cnt = ece391_getdents (fd, ents, sizeof (ents)))) {
         if (-1 == cnt) {
-	        ece391_fdputs (1, (uint8_t*)"directory entry read failed\n");
-	        return 3;
-	    }
-	    buf[cnt] = '\n';
-	    if (-1 == ece391_write (1, buf, cnt + 1))
-	        return 3;
+            ece391_fdputs (1, (uint8_t*)"directory entry read failed\n");
+            return 3;
+        }
+
+        for (i = 0; i < cnt / (int32_t)sizeof (ece391_dirent_t); i++) {
+            for (j = 0; j < NAMESIZE && '\0' != ents[i].name[j]; j++)
+                out[len++] = ents[i].name[j];
+            out[len++] = '\n';
+        }
     }
 
+    if (-1 == ece391_write (1, out, len))
+        return 3;
+
     return 0;
 }
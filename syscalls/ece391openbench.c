@@ -0,0 +1,61 @@
+#include <stdint.h>
+
+#include "ece391support.h"
+#include "ece391syscall.h"
+
+#define NAMESIZE 33
+#define RUN_SECS 10
+
+static uint8_t name[NAMESIZE];
+
+/* One open and close of the file */
+static int32_t open_close ()
+{
+    int32_t fd;
+
+    if (-1 == (fd = ece391_open (name)))
+        return -1;
+    ece391_close (fd);
+    return 0;
+}
+
+/*
+ * Name lookup benchmark. Finds the last file in the directory, the worst
+ * case for a linear scan of the boot block, then opens and closes it over
+ * and over for RUN_SECS seconds.
+ */
+int main ()
+{
+    int32_t fd, cnt, opens;
+    uint8_t buf[NAMESIZE];
+
+    /* The directory reads back one name per call */
+    if (-1 == (fd = ece391_open ((uint8_t*)"."))) {
+        ece391_fdputs (1, (uint8_t*)"directory open failed\n");
+        return 2;
+    }
+    name[0] = '\0';
+    while (0 != (cnt = ece391_read (fd, buf, NAMESIZE - 1))) {
+        if (-1 == cnt) {
+            ece391_fdputs (1, (uint8_t*)"directory entry read failed\n");
+            return 3;
+        }
+        buf[cnt] = '\0';
+        ece391_strcpy (name, buf);
+    }
+    ece391_close (fd);
+
+    ece391_fdputs (1, (uint8_t*)"Opening ");
+    ece391_fdputs (1, name);
+    ece391_put_num ((uint8_t*)", seconds: ", RUN_SECS);
+
+    if (-1 == (opens = ece391_run_for (RUN_SECS, open_close, 0))) {
+        ece391_fdputs (1, (uint8_t*)"file open failed\n");
+        return 2;
+    }
+
+    ece391_put_num ((uint8_t*)"opens: ", opens);
+    ece391_put_num ((uint8_t*)"opens per second: ", opens / RUN_SECS);
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include <stdint.h>
+
+#include "ece391support.h"
+#include "ece391syscall.h"
+
+#define BUFSIZE 1024
+#define RUN_SECS 5
+#define CHUNK 1024
+/* Each chunk takes two entries, its read and its write, so a batch fills the ring */
+#define BATCH (RING_ENTRIES / 2)
+
+static uint8_t bufs[BATCH][CHUNK];
+static uint8_t src_name[BUFSIZE];
+static uint8_t dst_name[] = "ringcopy.out";
+static ece391_ring_t* ring;
+
+/* Closes both files of a copy and passes ret back */
+static int32_t close_pair (int32_t src, int32_t dst, int32_t ret)
+{
+    ece391_close (src);
+    ece391_close (dst);
+    return ret;
+}
+
+/* Opens the source and an empty copy, returns the source's size or -1 */
+static int32_t open_pair (int32_t* src, int32_t* dst)
+{
+    ece391_stat_t st;
+
+    if (-1 == (*src = ece391_open (src_name)))
+        return -1;
+    if (-1 == (*dst = ece391_open (dst_name))) {
+        ece391_close (*src);
+        return -1;
+    }
+    if (-1 == ece391_truncate (*dst, 0) || -1 == ece391_fstat (*src, &st))
+        return close_pair (*src, *dst, -1);
+    return st.size;
+}
+
+/* One copy in CHUNK sized read and write calls */
+static int32_t copy_plain ()
+{
+    int32_t src, dst, cnt;
+
+    if (-1 == open_pair (&src, &dst))
+        return -1;
+    while (0 < (cnt = ece391_read (src, bufs[0], CHUNK))) {
+        if (cnt != ece391_write (dst, bufs[0], cnt))
+            return close_pair (src, dst, -1);
+    }
+    return close_pair (src, dst, cnt);
+}
+
+/* One copy with BATCH reads and their writes per kernel entry */
+static int32_t copy_ring ()
+{
+    int32_t src, dst, size, done, len, i;
+    ece391_cqe_t cqe;
+
+    if (-1 == (size = open_pair (&src, &dst)))
+        return -1;
+
+    /* Each read is followed by the write of the same buffer, the ring runs them in order */
+    for (done = 0; done < size; ) {
+        for (i = 0; i < BATCH && done < size; i++) {
+            len = (size - done < CHUNK) ? size - done : CHUNK;
+            if (-1 == ece391_ring_submit (ring, RING_OP_READ, src, bufs[i], len, len) ||
+                -1 == ece391_ring_submit (ring, RING_OP_WRITE, dst, bufs[i], len, len))
+                return close_pair (src, dst, -1);
+            done += len;
+        }
+        if (-1 == ece391_ring_enter ())
+            return close_pair (src, dst, -1);
+        while (ece391_ring_reap (ring, &cqe)) {
+            if (cqe.result != (int32_t)cqe.user_data)
+                return close_pair (src, dst, -1);
+        }
+    }
+    return close_pair (src, dst, 0);
+}
+
+/* Prints the results of one way of copying */
+static void report (const uint8_t* name, uint32_t copies, uint32_t size)
+{
+    ece391_fdputs(1, name);
+    ece391_put_num((uint8_t*)" copies: ", copies);
+    ece391_fdputs(1, name);
+    ece391_put_num((uint8_t*)" KB per second: ", copies * size / 1024 / RUN_SECS);
+}
+
+/*
+ * Ring benchmark. Copies the file named by its argument to ringcopy.out
+ * over and over for RUN_SECS seconds with plain read and write calls, then
+ * for RUN_SECS seconds through the submission ring, and reports both.
+ */
+int main ()
+{
+    int32_t copies;
+    ece391_stat_t st;
+
+    if (0 != ece391_getargs (src_name, BUFSIZE) || -1 == ece391_stat (src_name, &st) || 2 != st.type) {
+        ece391_fdputs (1, (uint8_t*)"usage: ringbench <file>\n");
+        return 3;
+    }
+    if (-1 == ece391_ring_setup (&ring)) {
+        ece391_fdputs (1, (uint8_t*)"ring setup failed\n");
+        return 2;
+    }
+    ece391_create (dst_name);
+
+    if (-1 == (copies = ece391_run_for (RUN_SECS, copy_plain, 0))) {
+        ece391_fdputs (1, (uint8_t*)"copy failed\n");
+        return 2;
+    }
+    report ((uint8_t*)"read/write", copies, st.size);
+
+    if (-1 == (copies = ece391_run_for (RUN_SECS, copy_ring, 0))) {
+        ece391_fdputs (1, (uint8_t*)"ring copy failed\n");
+        return 2;
+    }
+    report ((uint8_t*)"ring", copies, st.size);
+
+    return 0;
+}
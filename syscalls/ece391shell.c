@@ -4,10 +4,45 @@
 #include "ece391syscall.h"
 
 #define BUFSIZE 1024
+#define SAVED_STDIN 7
+
+/* run "left | right": left runs in a forked copy of the shell with its
+   stdout on a pipe, right runs from here with its stdin on the other end */
+int32_t
+run_pipeline (uint8_t* left, uint8_t* right)
+{
+    int32_t fds[2], rval;
+
+    if (-1 == ece391_pipe (fds))
+        return -1;
+    rval = ece391_fork ();
+    if (-1 == rval) {
+        ece391_close (fds[0]);
+        ece391_close (fds[1]);
+        return -1;
+    }
+    if (0 == rval) {
+        ece391_close (fds[0]);
+        ece391_copyfd (fds[1], 1);
+        ece391_close (fds[1]);
+        ece391_execute (left);
+        ece391_halt (0);
+    }
+
+    /* the reader only sees the end of the data once every write end is closed */
+    ece391_close (fds[1]);
+    ece391_copyfd (0, SAVED_STDIN);
+    ece391_copyfd (fds[0], 0);
+    ece391_close (fds[0]);
+    rval = ece391_execute (right);
+    ece391_copyfd (SAVED_STDIN, 0);
+    ece391_close (SAVED_STDIN);
+    return rval;
+}
 
 int main ()
 {
-    int32_t cnt, rval;
+    int32_t cnt, rval, bar, end;
     uint8_t buf[BUFSIZE];
     ece391_fdputs (1, (uint8_t*)"Starting 391 Shell\n");
 
@@ -24,7 +59,18 @@ int main ()
 	    return 0;
 	if ('\0' == buf[0])
 	    continue;
-	rval = ece391_execute (buf);
+	for (bar = 0; '\0' != buf[bar] && '|' != buf[bar]; bar++);
+	if ('|' == buf[bar]) {
+	    buf[bar] = '\0';
+	    for (end = bar; end > 0 && ' ' == buf[end - 1]; end--)
+	        buf[end - 1] = '\0';
+	    for (bar++; ' ' == buf[bar]; bar++);
+	    if ('\0' == buf[0] || '\0' == buf[bar])
+	        rval = -1;
+	    else
+	        rval = run_pipeline (buf, buf + bar);
+	} else
+	    rval = ece391_execute (buf);
 	if (-1 == rval)
 	    ece391_fdputs (1, (uint8_t*)"no such command\n");
 	else if (256 == rval)
@@ -102,3 +102,70 @@ uint8_t* ece391_strrev(uint8_t* s)
    return s;
 }
 
+/* Queue one operation on the ring, returns -1 if the submission queue is full */
+int32_t ece391_ring_submit(ece391_ring_t* ring, uint32_t op, int32_t fd, const void* addr, int32_t len, uint32_t user_data)
+{
+    ece391_sqe_t* sqe;
+
+    if (ring->sq_tail - ring->sq_head >= RING_ENTRIES)
+        return -1;
+    sqe = &ring->sq[ring->sq_tail % RING_ENTRIES];
+    sqe->op = op;
+    sqe->fd = fd;
+    sqe->addr = (uint32_t)addr;
+    sqe->len = len;
+    sqe->user_data = user_data;
+    ring->sq_tail++;
+    return 0;
+}
+
+/* Take the oldest completion off the ring, returns 0 if there is none */
+int32_t ece391_ring_reap(ece391_ring_t* ring, ece391_cqe_t* cqe)
+{
+    if (ring->cq_head == ring->cq_tail)
+        return 0;
+    *cqe = ring->cq[ring->cq_head % RING_ENTRIES];
+    ring->cq_head++;
+    return 1;
+}
+
+/* Waits for the tick count to change so timing starts on a tick boundary,
+   returns the new count */
+uint32_t ece391_tick_align(void)
+{
+    uint32_t start, now;
+
+    start = ece391_getticks();
+    while (start == (now = ece391_getticks()));
+    return now;
+}
+
+/* Runs step over and over from a tick boundary until secs seconds have
+   passed, returns how many times it ran or -1 as soon as a step fails.
+   ticks, if not 0, gets how long the runs really took. */
+int32_t ece391_run_for(uint32_t secs, int32_t (*step)(void), uint32_t* ticks)
+{
+    uint32_t start, end;
+    int32_t runs = 0;
+
+    start = ece391_tick_align();
+    end = start + secs * ECE391_TICKS_PER_SEC;
+    while (ece391_getticks() < end) {
+        if (-1 == step())
+            return -1;
+        runs++;
+    }
+    if (0 != ticks)
+        *ticks = ece391_getticks() - start;
+    return runs;
+}
+
+/* Prints the label, the value in decimal and a newline on stdout */
+void ece391_put_num(const uint8_t* label, uint32_t value)
+{
+    uint8_t buf[12];
+
+    ece391_fdputs(1, label);
+    ece391_fdputs(1, ece391_itoa(value, buf, 10));
+    ece391_fdputs(1, (uint8_t*)"\n");
+}
@@ -1,6 +1,8 @@
 #if !defined(ECE391SUPPORT_H)
 #define ECE391SUPPORT_H
 
+#include "ece391syscall.h"
+
 extern uint32_t ece391_strlen(const uint8_t* s);
 extern void ece391_strcpy(uint8_t* dst, const uint8_t* src);
 extern void ece391_fdputs(int32_t fd, const uint8_t* s);
@@ -8,6 +10,11 @@ extern int32_t ece391_strcmp(const uint8_t* s1, const uint8_t* s2);
 extern int32_t ece391_strncmp(const uint8_t* s1, const uint8_t* s2, uint32_t n);
 extern uint8_t *ece391_itoa(uint32_t value, uint8_t* buf, int32_t radix);
 extern uint8_t *ece391_strrev(uint8_t* s);
+extern int32_t ece391_ring_submit(ece391_ring_t* ring, uint32_t op, int32_t fd, const void* addr, int32_t len, uint32_t user_data);
+extern int32_t ece391_ring_reap(ece391_ring_t* ring, ece391_cqe_t* cqe);
+extern uint32_t ece391_tick_align(void);
+extern int32_t ece391_run_for(uint32_t secs, int32_t (*step)(void), uint32_t* ticks);
+extern void ece391_put_num(const uint8_t* label, uint32_t value);
 
 #endif /* ECE391SUPPORT_H */
 
@@ -5,6 +5,63 @@
 
 /* All calls return >= 0 on success or -1 on failure. */
 
+/* One directory entry as ece391_getdents fills it in, the name is not
+   terminated when it is 32 characters long */
+typedef struct ece391_dirent {
+    uint8_t name[32];
+    int32_t type;
+    int32_t inode;
+    uint32_t size;
+} ece391_dirent_t;
+
+/* What ece391_stat and ece391_fstat fill in, size is 0 unless type is 2,
+   type ECE391_PIPE_TYPE is an end of a pipe */
+#define ECE391_PIPE_TYPE 3
+typedef struct ece391_stat {
+    int32_t type;
+    int32_t inode;
+    uint32_t size;
+} ece391_stat_t;
+
+/* ece391_getticks counts at the kernel's SCHEDULING_RATE */
+#define ECE391_TICKS_PER_SEC 60
+
+/* One buffer of ece391_readv or ece391_writev, at most 16 per call */
+typedef struct ece391_iovec {
+    void* base;
+    int32_t len;
+} ece391_iovec_t;
+
+/* The ring ece391_ring_setup maps, the kernel runs the submissions at
+   ece391_ring_enter and leaves a completion for each in order */
+#define RING_ENTRIES 64
+#define RING_OP_READ 0
+#define RING_OP_WRITE 1
+#define RING_OP_OPEN 2
+#define RING_OP_CLOSE 3
+
+typedef struct ece391_sqe {
+    uint32_t op;
+    int32_t fd;
+    uint32_t addr;
+    int32_t len;
+    uint32_t user_data;
+} ece391_sqe_t;
+
+typedef struct ece391_cqe {
+    uint32_t user_data;
+    int32_t result;
+} ece391_cqe_t;
+
+typedef struct ece391_ring {
+    uint32_t sq_head;
+    uint32_t sq_tail;
+    uint32_t cq_head;
+    uint32_t cq_tail;
+    ece391_sqe_t sq[RING_ENTRIES];
+    ece391_cqe_t cq[RING_ENTRIES];
+} ece391_ring_t;
+
 /*  
  * Note that the system call for halt will have to make sure that only
  * the low byte of EBX (the status argument) is returned to the calling
@@ -21,6 +78,29 @@ extern int32_t ece391_getargs (uint8_t* buf, int32_t nbytes);
 extern int32_t ece391_vidmap (uint8_t** screen_start);
 extern int32_t ece391_set_handler (int32_t signum, void* handler);
 extern int32_t ece391_sigreturn (void);
+extern int32_t ece391_getticks (void);
+extern int32_t ece391_fork (void);
+extern int32_t ece391_mmap (int32_t fd, void** addr);
+extern int32_t ece391_munmap (void* addr);
+extern int32_t ece391_create (const uint8_t* filename);
+extern int32_t ece391_truncate (int32_t fd, uint32_t length);
+extern int32_t ece391_sync (void);
+extern int32_t ece391_cachestat (uint32_t* stats);
+extern int32_t ece391_getdents (int32_t fd, void* buf, int32_t nbytes);
+extern int32_t ece391_stat (const uint8_t* filename, ece391_stat_t* buf);
+extern int32_t ece391_fstat (int32_t fd, ece391_stat_t* buf);
+extern int32_t ece391_ring_setup (ece391_ring_t** ring);
+extern int32_t ece391_ring_enter (void);
+extern int32_t ece391_readv (int32_t fd, const ece391_iovec_t* iov, int32_t iovcnt);
+extern int32_t ece391_writev (int32_t fd, const ece391_iovec_t* iov, int32_t iovcnt);
+extern int32_t ece391_pipe (int32_t fds[2]);
+extern int32_t ece391_copyfd (int32_t old_fd, int32_t new_fd);
+extern int32_t ece391_has_sysenter (void);
+
+/* The same calls through SYSENTER instead of int $0x80 */
+extern int32_t ece391_fast_read (int32_t fd, void* buf, int32_t nbytes);
+extern int32_t ece391_fast_write (int32_t fd, const void* buf, int32_t nbytes);
+extern int32_t ece391_fast_getticks (void);
 
 enum signums {
 	DIV_ZERO = 0,
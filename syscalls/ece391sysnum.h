@@ -11,5 +11,23 @@
 #define SYS_VIDMAP  8
 #define SYS_SET_HANDLER  9
 #define SYS_SIGRETURN  10
+#define SYS_GETTICKS 11
+#define SYS_FORK 12
+#define SYS_MMAP 13
+#define SYS_MUNMAP 14
+#define SYS_CREATE 15
+#define SYS_TRUNCATE 16
+#define SYS_SYNC 17
+#define SYS_CACHESTAT 18
+#define SYS_GETDENTS 19
+#define SYS_STAT 20
+#define SYS_FSTAT 21
+#define SYS_RING_SETUP 22
+#define SYS_RING_ENTER 23
+#define SYS_READV 24
+#define SYS_WRITEV 25
+#define SYS_PIPE 26
+#define SYS_COPYFD 27
+#define SYS_HAS_SYSENTER 28
 
 #endif /* ECE391SYSNUM_H */
@@ -0,0 +1,51 @@
+#include <stdint.h>
+
+#include "ece391support.h"
+#include "ece391syscall.h"
+
+#define RUN_SECS 10
+#define PAGE_SIZE 4096
+#define NUM_PAGES 64
+
+static uint8_t pages[NUM_PAGES * PAGE_SIZE];
+
+/* One vidmap call, then a touch of every page */
+static int32_t remap_and_touch ()
+{
+    uint8_t* screen;
+    uint32_t i;
+
+    if (-1 == ece391_vidmap(&screen))
+        return -1;
+    for (i = 0; i < NUM_PAGES; i++)
+        pages[i * PAGE_SIZE]++;
+    return 0;
+}
+
+/*
+ * TLB benchmark. Each loop makes a vidmap call, which rewrites one page
+ * table entry in the kernel, then touches NUM_PAGES different user pages.
+ * If the kernel throws away the whole TLB on that one change, every touch
+ * misses, so the loop count over RUN_SECS seconds drops.
+ */
+int main ()
+{
+    int32_t loops;
+    uint32_t i;
+
+    ece391_put_num((uint8_t*)"Seconds of vidmap loop: ", RUN_SECS);
+
+    /* Fault every page in up front so only TLB misses are left */
+    for (i = 0; i < NUM_PAGES; i++)
+        pages[i * PAGE_SIZE] = 0;
+
+    if (-1 == (loops = ece391_run_for(RUN_SECS, remap_and_touch, 0))) {
+        ece391_fdputs(1, (uint8_t*)"vidmap failed\n");
+        return 2;
+    }
+
+    ece391_put_num((uint8_t*)"loops: ", loops);
+    ece391_put_num((uint8_t*)"loops per second: ", loops / RUN_SECS);
+
+    return 0;
+}
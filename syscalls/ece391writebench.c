@@ -0,0 +1,50 @@
+#include <stdint.h>
+
+#include "ece391support.h"
+#include "ece391syscall.h"
+
+#define BUFSIZE 1024
+#define CHUNK 4096
+#define CHUNKS_PER_MB 256
+#define LINE_LEN 64
+
+/* Turns the argument into a number of megabytes, 1 if there is none */
+static uint32_t parse_mb (const uint8_t* arg)
+{
+    uint32_t mb = 0;
+
+    while (*arg >= '0' && *arg <= '9')
+        mb = mb * 10 + (*arg++ - '0');
+    return (0 == mb) ? 1 : mb;
+}
+
+/*
+ * Terminal throughput benchmark. Writes N megabytes (the argument) of
+ * text lines to stdout in 4 KB writes and reports the elapsed PIT ticks.
+ */
+int main ()
+{
+    uint8_t arg[BUFSIZE];
+    uint8_t chunk[CHUNK];
+    uint32_t i, mb, start, ticks;
+
+    if (0 != ece391_getargs (arg, BUFSIZE))
+        arg[0] = '\0';
+    mb = parse_mb (arg);
+
+    /* Lines of letters, each one shifted from the last so scrolling shows */
+    for (i = 0; i < CHUNK; i++)
+        chunk[i] = (LINE_LEN - 1 == i % LINE_LEN) ? '\n' : 'a' + (i + i / LINE_LEN) % 26;
+
+    start = ece391_tick_align ();
+    for (i = 0; i < mb * CHUNKS_PER_MB; i++) {
+        if (-1 == ece391_write (1, chunk, CHUNK))
+            return 3;
+    }
+    ticks = ece391_getticks () - start;
+
+    ece391_put_num ((uint8_t*)"MB written: ", mb);
+    ece391_put_num ((uint8_t*)"ticks: ", ticks);
+    ece391_put_num ((uint8_t*)"KB per second: ", mb * 1024 * ECE391_TICKS_PER_SEC / (ticks + 1));
+    return 0;
+}